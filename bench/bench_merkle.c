@@ -0,0 +1,87 @@
+#include "../src/memory.h"
+#include "../src/merkle_tree.h"
+#include "itsuku_bench.h"
+#include <stdio.h>
+
+#define PATH_LOOKUPS 2000000
+
+/**
+ * @brief Walks `count` authentication paths from pseudo-random leaves to the
+ * root, reading every node and its sibling. Returns a checksum so the reads
+ * cannot be optimized away.
+ */
+static uint64_t walk_random_paths(const MerkleTree *tree, size_t count) {
+  size_t leaf_count = tree->config.chunk_count * tree->config.chunk_size;
+  uint64_t state = 0x9E3779B97F4A7C15UL;
+  uint64_t checksum = 0;
+
+  for (size_t n = 0; n < count; ++n) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    size_t index = leaf_count - 1 + (size_t)(state % leaf_count);
+
+    while (index > 0) {
+      size_t sibling = (index % 2 == 0) ? index - 1 : index + 1;
+      const uint8_t *node = MerkleTree__get_node(tree, index);
+      const uint8_t *other = MerkleTree__get_node(tree, sibling);
+      checksum += (uint64_t)(node[0] ^ other[tree->node_size - 1]);
+      index = (index - 1) / 2;
+    }
+  }
+  return checksum;
+}
+
+/**
+ * @brief Compares packed node storage with 8- and 16-byte aligned strides:
+ * memory footprint, full tree build time and random path reads.
+ */
+void bench_merkle_node_stride() {
+  Config config = bench_config();
+  ChallengeId *challenge_id = build_bench_challenge_id();
+  Memory *memory = Memory__new(config);
+  if (!memory) {
+    fprintf(stderr, "  Failed to allocate Memory\n");
+    ChallengeId__drop(challenge_id);
+    return;
+  }
+  Memory__build_all_chunks(memory, challenge_id);
+
+  printf("  [Bench] Merkle node stride (node_size=%zu, leaves=%zu)\n",
+         MerkleTree__calculate_node_size(&config),
+         config.chunk_count * config.chunk_size);
+  printf("  %-8s %-8s %12s %12s %16s\n", "align", "stride", "bytes",
+         "build [ms]", "path reads [ns]");
+
+  size_t alignments[] = {0, 8, 16};
+  for (size_t a = 0; a < sizeof(alignments) / sizeof(alignments[0]); ++a) {
+    MerkleTree *tree = MerkleTree__new_with_stride(config, alignments[a]);
+    if (!tree) {
+      fprintf(stderr, "  Failed to allocate MerkleTree\n");
+      continue;
+    }
+
+    double start = bench_now();
+    MerkleTree__compute_leaf_hashes(tree, challenge_id, memory);
+    MerkleTree__compute_intermediate_nodes(tree, challenge_id);
+    double build_time = bench_now() - start;
+
+    size_t depth = 0;
+    for (size_t n = MerkleTree__node_count(tree); n > 1; n /= 2)
+      depth++;
+
+    start = bench_now();
+    volatile uint64_t checksum = walk_random_paths(tree, PATH_LOOKUPS);
+    (void)checksum;
+    double walk_time = bench_now() - start;
+
+    printf("  %-8zu %-8zu %12zu %12.2f %16.2f\n", alignments[a],
+           tree->node_stride, tree->nodes_len, build_time * 1e3,
+           walk_time * 1e9 / ((double)PATH_LOOKUPS * (double)depth));
+
+    MerkleTree__drop(tree);
+  }
+
+  Memory__drop(memory);
+  ChallengeId__drop(challenge_id);
+}
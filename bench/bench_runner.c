@@ -0,0 +1,50 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+
+#include "itsuku_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// =================================================================
+// AUXILIARY FUNCTIONS
+// =================================================================
+
+double bench_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+ChallengeId *build_bench_challenge_id() {
+  uint8_t bytes[64];
+  for (int i = 0; i < 64; ++i) {
+    bytes[i] = (uint8_t)(0xA5 ^ i);
+  }
+  return ChallengeId__new(bytes, 64);
+}
+
+Config bench_config() {
+  Config config = Config__default();
+  config.chunk_count = 64;
+  config.chunk_size = 4096;
+  return config;
+}
+
+// =================================================================
+// MAIN BENCHMARK FUNCTION
+// =================================================================
+
+int main() {
+  printf("--- Running Itsuku Benchmarks ---\n");
+
+  printf("\n--- Merkle Tree ---\n");
+  bench_merkle_node_stride();
+
+  printf("\n--- Search ---\n");
+  bench_search_thread_scaling();
+  bench_search_omega_lanes();
+  bench_search_interleave();
+
+  printf("\n--- Benchmarks Completed ---\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,236 @@
+#include "../src/memory.h"
+#include "../src/merkle_tree.h"
+#include "../src/proof.h"
+#include "../src/search.h"
+#include "itsuku_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SEARCH_BENCH_DIFFICULTY 16
+#define OMEGA_BENCH_NONCES 20000
+
+/**
+ * @brief Shared fixture: bench_config() memory and Merkle tree, built once.
+ */
+typedef struct BenchFixture {
+  Config config;
+  ChallengeId *challenge_id;
+  Memory *memory;
+  MerkleTree *merkle_tree;
+} BenchFixture;
+
+static bool BenchFixture__init(BenchFixture *self, size_t difficulty_bits) {
+  self->config = bench_config();
+  self->config.difficulty_bits = difficulty_bits;
+  self->challenge_id = build_bench_challenge_id();
+  self->memory = Memory__new(self->config);
+  self->merkle_tree = MerkleTree__new(self->config);
+  if (!self->memory || !self->merkle_tree) {
+    fprintf(stderr, "  Failed to allocate the search fixture\n");
+    Memory__drop(self->memory);
+    MerkleTree__drop(self->merkle_tree);
+    ChallengeId__drop(self->challenge_id);
+    return false;
+  }
+
+  Memory__build_all_chunks(self->memory, self->challenge_id);
+  MerkleTree__compute_leaf_hashes(self->merkle_tree, self->challenge_id,
+                                  self->memory);
+  MerkleTree__compute_intermediate_nodes(self->merkle_tree,
+                                         self->challenge_id);
+  return true;
+}
+
+static void BenchFixture__drop(BenchFixture *self) {
+  MerkleTree__drop(self->merkle_tree);
+  Memory__drop(self->memory);
+  ChallengeId__drop(self->challenge_id);
+}
+
+/**
+ * @brief Measures search hashrate for 1, 2, 4, ... threads up to the number
+ * of online CPUs. In lowest-nonce mode every nonce below the winner is
+ * evaluated, so the winning nonce approximates the work done.
+ */
+void bench_search_thread_scaling() {
+  BenchFixture fixture;
+  if (!BenchFixture__init(&fixture, SEARCH_BENCH_DIFFICULTY))
+    return;
+
+  SearchOptions options = SearchOptions__default();
+  size_t max_threads = SearchOptions__effective_thread_count(&options);
+
+  printf("  [Bench] Search thread scaling (d=%zu)\n",
+         fixture.config.difficulty_bits);
+  printf("  %-8s %12s %12s %14s %10s\n", "threads", "nonce", "time [ms]",
+         "hashrate [H/s]", "speedup");
+
+  double base_rate = 0.0;
+  for (size_t threads = 1;; threads *= 2) {
+    if (threads > max_threads)
+      threads = max_threads;
+    options.thread_count = threads;
+
+    double start = bench_now();
+    Proof *proof = Proof__search_with_options(
+        fixture.config, fixture.challenge_id, fixture.memory,
+        fixture.merkle_tree, &options);
+    double elapsed = bench_now() - start;
+
+    if (!proof) {
+      fprintf(stderr, "  Search failed\n");
+      break;
+    }
+
+    double rate = (double)proof->nonce / elapsed;
+    if (threads == 1)
+      base_rate = rate;
+    printf("  %-8zu %12llu %12.2f %14.0f %9.2fx\n", threads,
+           (unsigned long long)proof->nonce, elapsed * 1e3, rate,
+           rate / base_rate);
+    Proof__drop(proof);
+
+    if (threads == max_threads)
+      break;
+  }
+
+  BenchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Compares single-nonce Omega evaluation with the multi-lane
+ * evaluator, through the wrapper and with direct memory access, on one
+ * core over the same OMEGA_BENCH_NONCES nonces.
+ */
+void bench_search_omega_lanes() {
+  BenchFixture fixture;
+  if (!BenchFixture__init(&fixture, SEARCH_BENCH_DIFFICULTY))
+    return;
+
+  Config *config = &fixture.config;
+  size_t L = config->search_length;
+  size_t memory_size = config->chunk_count * config->chunk_size;
+  PartialMemory_Wrapper memory = Memory__as_partial(fixture.memory);
+  uint8_t root_hash[64];
+  Proof__padded_root(fixture.merkle_tree, root_hash);
+
+  size_t *leaves = malloc(L * sizeof(size_t));
+  uint8_t (*path)[64] = malloc(BLAKE3_LANE_COUNT * (L + 1) * 64);
+  if (!leaves || !path) {
+    fprintf(stderr, "  Failed to allocate Omega buffers\n");
+    free(leaves);
+    free(path);
+    BenchFixture__drop(&fixture);
+    return;
+  }
+
+  printf("  [Bench] Omega evaluation, %d nonces (L=%zu)\n",
+         OMEGA_BENCH_NONCES, L);
+  printf("  %-8s %12s %14s %10s\n", "lanes", "time [ms]", "hashrate [H/s]",
+         "speedup");
+
+  uint8_t omegas[BLAKE3_LANE_COUNT][64];
+  double start = bench_now();
+  for (uint64_t nonce = 1; nonce <= OMEGA_BENCH_NONCES; ++nonce) {
+    Proof__calculate_omega_no_alloc(omegas[0], leaves, path, config,
+                                    fixture.challenge_id, memory,
+                                    (PartialMerkleTree_Wrapper){0}, root_hash,
+                                    memory_size, nonce);
+  }
+  double scalar = bench_now() - start;
+  printf("  %-8d %12.2f %14.0f %9.2fx\n", 1, scalar * 1e3,
+         OMEGA_BENCH_NONCES / scalar, 1.0);
+
+  uint64_t nonces[BLAKE3_LANE_COUNT];
+  start = bench_now();
+  for (uint64_t nonce = 1; nonce <= OMEGA_BENCH_NONCES;
+       nonce += BLAKE3_LANE_COUNT) {
+    for (size_t l = 0; l < BLAKE3_LANE_COUNT; ++l) {
+      nonces[l] = nonce + l;
+    }
+    Proof__calculate_omega_lanes(omegas, nonces, BLAKE3_LANE_COUNT, path,
+                                 config, fixture.challenge_id, memory,
+                                 root_hash, memory_size);
+  }
+  double lanes = bench_now() - start;
+  printf("  %-8d %12.2f %14.0f %9.2fx\n", BLAKE3_LANE_COUNT, lanes * 1e3,
+         OMEGA_BENCH_NONCES / lanes, scalar / lanes);
+
+  // Same lanes, reading the full Memory through direct pointers
+  start = bench_now();
+  for (uint64_t nonce = 1; nonce <= OMEGA_BENCH_NONCES;
+       nonce += BLAKE3_LANE_COUNT) {
+    for (size_t l = 0; l < BLAKE3_LANE_COUNT; ++l) {
+      nonces[l] = nonce + l;
+    }
+    Proof__calculate_omega_full(omegas, nonces, BLAKE3_LANE_COUNT, path,
+                                config, fixture.challenge_id, fixture.memory,
+                                root_hash);
+  }
+  double direct = bench_now() - start;
+  printf("  %-8s %12.2f %14.0f %9.2fx\n", "8 direct", direct * 1e3,
+         OMEGA_BENCH_NONCES / direct, scalar / direct);
+
+  free(leaves);
+  free(path);
+  BenchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Sweeps the number of nonces in flight (K) on one core and reports
+ * the fastest setting for this host, to be used as SearchOptions.interleave.
+ */
+void bench_search_interleave() {
+  BenchFixture fixture;
+  if (!BenchFixture__init(&fixture, SEARCH_BENCH_DIFFICULTY))
+    return;
+
+  Config *config = &fixture.config;
+  size_t L = config->search_length;
+  size_t memory_size = config->chunk_count * config->chunk_size;
+  PartialMemory_Wrapper memory = Memory__as_partial(fixture.memory);
+  uint8_t root_hash[64];
+  Proof__padded_root(fixture.merkle_tree, root_hash);
+
+  uint8_t (*path)[64] = malloc(OMEGA_MAX_IN_FLIGHT * (L + 1) * 64);
+  uint8_t (*omegas)[64] = malloc(OMEGA_MAX_IN_FLIGHT * 64);
+  if (!path || !omegas) {
+    fprintf(stderr, "  Failed to allocate Omega buffers\n");
+    free(path);
+    free(omegas);
+    BenchFixture__drop(&fixture);
+    return;
+  }
+
+  printf("  [Bench] Nonces in flight, %d nonces (L=%zu)\n", OMEGA_BENCH_NONCES,
+         L);
+  printf("  %-8s %12s %14s\n", "K", "time [ms]", "hashrate [H/s]");
+
+  uint64_t nonces[OMEGA_MAX_IN_FLIGHT];
+  size_t best_k = 1;
+  double best_rate = 0.0;
+  for (size_t k = 1; k <= OMEGA_MAX_IN_FLIGHT; k *= 2) {
+    double start = bench_now();
+    for (uint64_t nonce = 1; nonce <= OMEGA_BENCH_NONCES; nonce += k) {
+      for (size_t n = 0; n < k; ++n) {
+        nonces[n] = nonce + n;
+      }
+      Proof__calculate_omega_interleaved(omegas, nonces, k, path, config,
+                                         fixture.challenge_id, memory,
+                                         root_hash, memory_size);
+    }
+    double elapsed = bench_now() - start;
+    double rate = OMEGA_BENCH_NONCES / elapsed;
+    printf("  %-8zu %12.2f %14.0f\n", k, elapsed * 1e3, rate);
+
+    if (rate > best_rate) {
+      best_rate = rate;
+      best_k = k;
+    }
+  }
+  printf("  Best K on this host: %zu\n", best_k);
+
+  free(path);
+  free(omegas);
+  BenchFixture__drop(&fixture);
+}
@@ -0,0 +1,35 @@
+#ifndef ITSUKU_BENCH_H
+#define ITSUKU_BENCH_H
+
+#include "../src/challenge_id.h"
+#include "../src/config.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Returns a monotonic timestamp in seconds.
+ */
+double bench_now();
+
+/**
+ * @brief Builds the deterministic ChallengeId shared by all benchmarks.
+ */
+ChallengeId *build_bench_challenge_id();
+
+/**
+ * @brief Returns the configuration used by benchmarks (16 MiB of memory).
+ */
+Config bench_config();
+
+// --- BENCHMARK GROUP DECLARATIONS ---
+
+// Merkle Tree
+void bench_merkle_node_stride();
+
+// Search
+void bench_search_thread_scaling();
+void bench_search_omega_lanes();
+void bench_search_interleave();
+
+#endif // ITSUKU_BENCH_H
@@ -10,16 +10,21 @@
 
 // --- Dołączenie interfejsów publicznych biblioteki ---
 #include "../src/challenge_id.h"
+#include "../src/checkpoint.h"
 #include "../src/config.h"
+#include "../src/coordinator.h"
 #include "../src/hashmap.h"
 #include "../src/memory.h"
 #include "../src/merkle_tree.h"
 #include "../src/proof.h"
+#include "../src/search.h"
+#include "../src/solver.h"
 
 // --- Definicje stałych ---
 #define ITSUKU_HASH_SIZE 64
 #define ITSUKU_NONCE_SIZE 8
 #define ITSUKU_ELEMENT_SIZE 64
+#define ITSUKU_WORK_JOB_SIZE 4096 // Nonces per job handed to a worker
 
 // Złoty Wzorzec z testu Rust dla Config (użyty do obliczeń)
 const size_t DEFAULT_NODE_SIZE = 5;
@@ -57,11 +62,10 @@ static void serialize_proof(const Proof *proof, size_t node_size) {
   // Proof__verify. Zamiast tego, wyświetlamy kluczowe dane.
   // print_hex(stdout, "OMEGA_HASH", proof->omega_hash, ITSUKU_HASH_SIZE);
 
-  // Hash Korzenia (Root Hash) jest w tree_opening pod indeksem 0
-  const uint8_t *root_hash_ptr =
-      (const uint8_t *)HashMap__get(proof->tree_opening, 0);
-  if (root_hash_ptr) {
-    print_hex(stdout, "ROOT_HASH", root_hash_ptr, node_size);
+  // Hash Korzenia (Root Hash) nie jest częścią multiproofu; Proof niesie
+  // zadeklarowany korzeń, który weryfikator odtwarza z multiproofu
+  if (proof->root_hash) {
+    print_hex(stdout, "ROOT_HASH", proof->root_hash, node_size);
   } else {
     fprintf(stdout, "ROOT_HASH: MISSING\n");
   }
@@ -73,37 +77,35 @@ static void serialize_proof(const Proof *proof, size_t node_size) {
 
   // 3. Collective Opening (Z) - Merkle Proof Nodes
   fprintf(stdout, "MERKLE_PROOF_NODE_SIZE: %zu\n", node_size);
-  fprintf(stdout, "MERKLE_PROOF_NODES_COUNT: %zu\n",
-          HashMap__size(proof->tree_opening));
+  fprintf(stdout, "MERKLE_PROOF_NODES_COUNT: %zu\n", proof->node_count);
 
-  // Wypisanie wszystkich węzłów (index:hash) z tree_opening
-  HashMapIterator node_iter = HashMapIterator__new(proof->tree_opening);
-  size_t node_index;
-  void *hash_ptr;
-
-  while (HashMapIterator__next(&node_iter, &node_index, &hash_ptr)) {
+  // Wypisanie wszystkich węzłów (index:hash) w kolejności indeksów
+  for (size_t i = 0; i < proof->node_count; ++i) {
+    size_t node_index = proof->node_indices[i];
     fprintf(stdout, "NODE_%zu_INDEX: %zu\n", node_index, node_index);
-    print_hex(stdout, "NODE_HASH", (const uint8_t *)hash_ptr, node_size);
+    print_hex(stdout, "NODE_HASH", &proof->node_hashes[i * node_size],
+              node_size);
   }
 
   // 4. Collective Opening (Z) - Leaf Data (leaf_antecedents)
-  fprintf(stdout, "LEAF_COUNT: %zu\n", HashMap__size(proof->leaf_antecedents));
+  fprintf(stdout, "LEAF_COUNT: %zu\n", proof->leaf_count);
 
-  // Wypisanie antecedentów dla każdego liścia
-  HashMapIterator leaf_iter = HashMapIterator__new(proof->leaf_antecedents);
-  size_t leaf_index;
-  void *antecedents_ptr;
+  // Wypisanie wszystkich antecedentów dla każdego liścia
+  for (size_t i = 0; i < proof->leaf_count; ++i) {
+    size_t leaf_index = proof->leaf_indices[i];
+    size_t antecedent_count = 0;
+    const Element *antecedents =
+        Proof__get_antecedents(proof, leaf_index, &antecedent_count);
 
-  while (HashMapIterator__next(&leaf_iter, &leaf_index, &antecedents_ptr)) {
     fprintf(stdout, "LEAF_INDEX: %zu\n", leaf_index);
-    // Wartość jest Element* (ciąg elementów)
-    const Element *antecedents = (const Element *)antecedents_ptr;
-
-    // Wypisujemy tylko pierwszy element z ciągu antecedentów jako
-    // reprezentatywny. Pełne wypisanie wymagałoby znajomości długości ciągu, co
-    // jest trudne.
-    print_hex(stdout, "LEAF_ANTECEDENT_0_DATA", (void *)antecedents[0].data,
-              ITSUKU_ELEMENT_SIZE);
+    fprintf(stdout, "LEAF_ANTECEDENT_COUNT: %zu\n", antecedent_count);
+    for (size_t k = 0; k < antecedent_count; ++k) {
+      char label[48];
+      uint8_t element_bytes[ITSUKU_ELEMENT_SIZE];
+      snprintf(label, sizeof(label), "LEAF_ANTECEDENT_%zu_DATA", k);
+      Element__to_le_bytes(&antecedents[k], element_bytes);
+      print_hex(stdout, label, element_bytes, ITSUKU_ELEMENT_SIZE);
+    }
   }
 }
 
@@ -146,6 +148,24 @@ static void print_usage(const char *prog_name) {
   fprintf(stderr, "  -c, --chunks N        Set the total chunk count (P).\n");
   fprintf(stderr, "  -s, --chunk-size N    Set the chunk size (l).\n");
   fprintf(stderr, "  -a, --antecedents N   Set the antecedent count (n).\n");
+  fprintf(stderr, "  -t, --threads N       Set the number of search threads "
+                  "(0 = all CPUs).\n");
+  fprintf(stderr, "  -k, --interleave K    Keep K nonces in flight per thread "
+                  "(0 = default).\n");
+  fprintf(stderr, "  -T, --timeout SEC     Abort the search after SEC seconds "
+                  "(0 = no limit).\n");
+  fprintf(stderr, "  -u, --cpu-share F     Use at most the fraction F (0-1] of "
+                  "the CPU quota.\n");
+  fprintf(stderr, "  -p, --progress N      Report progress every N nonces "
+                  "(0 = off).\n");
+  fprintf(stderr, "  -S, --share BITS      Report every nonce with at least "
+                  "BITS leading zeros.\n");
+  fprintf(stderr, "  -C, --checkpoint FILE Save the search frontier to FILE "
+                  "and resume from it.\n");
+  fprintf(stderr, "  -L, --listen SOCKET   Hand the search out to workers "
+                  "connecting to SOCKET.\n");
+  fprintf(stderr, "  -W, --work SOCKET     Run as a worker of the coordinator "
+                  "at SOCKET.\n");
   fprintf(stderr, "  -r, --random          Generate a random Challenge ID (I) "
                   "instead of using -i.\n");
   fprintf(stderr,
@@ -153,14 +173,42 @@ static void print_usage(const char *prog_name) {
   fprintf(stderr, "\nExample: %s -r -d 10\n", prog_name);
 }
 
+/**
+ * @brief Progress callback: one status line per report on stderr.
+ */
+static void print_progress(const SearchProgress *progress, void *user_data) {
+  (void)user_data;
+  double rate = progress->elapsed_seconds > 0
+                    ? (double)progress->nonces_tried / progress->elapsed_seconds
+                    : 0.0;
+  fprintf(stderr,
+          "  ... %llu nonces tried (%.0f/s), best leading zeros: %zu\n",
+          (unsigned long long)progress->nonces_tried, rate,
+          progress->best_leading_zeros);
+}
+
+/**
+ * @brief Share callback: one line per share on stderr.
+ */
+static void print_share(const SearchShare *share, void *user_data) {
+  (void)user_data;
+  fprintf(stderr, "  ... share: nonce %llu, leading zeros: %zu\n",
+          (unsigned long long)share->nonce, share->leading_zeros);
+}
+
 // --- Main Program ---
 
 int main(int argc, char *argv[]) {
   int generate_random_id = 0;
   int challenge_id_provided = 0;
+  const char *checkpoint_path = NULL;
+  const char *listen_path = NULL;
+  const char *work_path = NULL;
+  double cpu_share = 0.0;
 
   // Inicjalizacja konfiguracji na wartości domyślne
   Config config = Config__default();
+  SearchOptions search_options = SearchOptions__default();
 
   // Final Challenge ID structure
   ChallengeId challenge_id;
@@ -181,6 +229,15 @@ int main(int argc, char *argv[]) {
       {"chunks", required_argument, 0, 'c'},
       {"chunk-size", required_argument, 0, 's'},
       {"antecedents", required_argument, 0, 'a'},
+      {"threads", required_argument, 0, 't'},
+      {"interleave", required_argument, 0, 'k'},
+      {"timeout", required_argument, 0, 'T'},
+      {"cpu-share", required_argument, 0, 'u'},
+      {"progress", required_argument, 0, 'p'},
+      {"share", required_argument, 0, 'S'},
+      {"checkpoint", required_argument, 0, 'C'},
+      {"listen", required_argument, 0, 'L'},
+      {"work", required_argument, 0, 'W'},
       {"random", no_argument, 0, 'r'},
       {"help", no_argument, 0, 'h'},
       {0, 0, 0, 0}};
@@ -188,8 +245,8 @@ int main(int argc, char *argv[]) {
   int c;
   int option_index = 0;
 
-  while ((c = getopt_long(argc, argv, "i:d:l:c:s:a:rh", long_options,
-                          &option_index)) != -1) {
+  while ((c = getopt_long(argc, argv, "i:d:l:c:s:a:t:k:T:u:p:S:C:L:W:rh",
+                          long_options, &option_index)) != -1) {
     char *endptr;
     unsigned long val;
 
@@ -212,6 +269,10 @@ int main(int argc, char *argv[]) {
     case 'c': // Chunk Count
     case 's': // Chunk Size
     case 'a': // Antecedent Count
+    case 't': // Search Threads
+    case 'k': // Interleave Depth
+    case 'p': // Progress Interval
+    case 'S': // Share Difficulty
       errno = 0;
       val = strtoul(optarg, &endptr, 10);
       if (*endptr != '\0' || errno != 0) {
@@ -238,9 +299,59 @@ int main(int argc, char *argv[]) {
       case 'a':
         config.antecedent_count = (size_t)val;
         break;
+      case 't':
+        search_options.thread_count = (size_t)val;
+        break;
+      case 'k':
+        search_options.interleave = (size_t)val;
+        break;
+      case 'p':
+        search_options.progress = val ? print_progress : NULL;
+        search_options.progress_interval = (uint64_t)val;
+        break;
+      case 'S':
+        search_options.share_difficulty_bits = (size_t)val;
+        search_options.share = print_share;
+        break;
+      }
+      break;
+
+    case 'T': // Limit czasu wyszukiwania
+      errno = 0;
+      search_options.deadline_seconds = strtod(optarg, &endptr);
+      if (*endptr != '\0' || errno != 0 ||
+          search_options.deadline_seconds < 0) {
+        fprintf(stderr, "Error: Argument for -T must be a non-negative "
+                        "number of seconds.\n");
+        free(challenge_id.bytes);
+        return 1;
+      }
+      break;
+
+    case 'u': // Udział w limicie CPU
+      errno = 0;
+      cpu_share = strtod(optarg, &endptr);
+      if (*endptr != '\0' || errno != 0 || cpu_share <= 0 ||
+          cpu_share > 1) {
+        fprintf(stderr, "Error: Argument for -u must be a fraction in "
+                        "(0, 1].\n");
+        free(challenge_id.bytes);
+        return 1;
       }
       break;
 
+    case 'C': // Plik punktu kontrolnego
+      checkpoint_path = optarg;
+      break;
+
+    case 'L': // Gniazdo koordynatora
+      listen_path = optarg;
+      break;
+
+    case 'W': // Tryb robotnika
+      work_path = optarg;
+      break;
+
     case 'r': // Generate Random ID
       generate_random_id = 1;
       break;
@@ -260,6 +371,21 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  // Tryb dławiony: liczba wątków i cykl pracy wynikają z limitu cgroup
+  if (cpu_share > 0)
+    SearchOptions__fit_cpu_quota(&search_options, cpu_share);
+
+  // Robotnik dostaje wyzwanie i konfigurację od koordynatora
+  if (work_path) {
+    free(challenge_id.bytes);
+    fprintf(stderr, "Working for the coordinator at %s.\n", work_path);
+    if (!WorkWorker__run(work_path, &search_options)) {
+      fprintf(stderr, "Error: Lost the connection to %s.\n", work_path);
+      return 1;
+    }
+    return 0;
+  }
+
   // --- 1. Finalize Challenge ID (I) ---
   if (!challenge_id_provided && !generate_random_id) {
     fprintf(stderr, "Error: Challenge ID is required. Use -i or -r.\n");
@@ -292,29 +418,42 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
-  Memory *memory = Memory__new(config);
-  if (!memory) {
-    fprintf(stderr, "Error: Failed to allocate Memory.\n");
-    ChallengeId__drop(challenge_id_ptr);
-    free(challenge_id.bytes);
-    return 1;
+  // Punkt kontrolny: wznawiamy od zapisanego frontu wyszukiwania, a podczas
+  // wyszukiwania zapisujemy go co najwyżej raz na sekundę
+  SearchCheckpointWriter checkpoint_writer;
+  uint64_t start_nonce = 1;
+  if (checkpoint_path) {
+    checkpoint_writer = (SearchCheckpointWriter){
+        .checkpoint = SearchCheckpoint__new(&config, challenge_id_ptr, 1, 1),
+        .path = checkpoint_path,
+        .interval_seconds = 1.0,
+        .saved_at = 0.0,
+        .next = search_options.progress,
+        .next_user_data = search_options.progress_user_data,
+    };
+    if (SearchCheckpoint__load(&checkpoint_writer.checkpoint,
+                               checkpoint_path)) {
+      start_nonce = checkpoint_writer.checkpoint.next_nonce;
+      fprintf(stderr, "Resuming from checkpoint %s at nonce %llu.\n",
+              checkpoint_path, (unsigned long long)start_nonce);
+    }
+    search_options.progress = SearchCheckpointWriter__report;
+    search_options.progress_user_data = &checkpoint_writer;
   }
 
-  // Wypełniamy pamięć
-  Memory__build_all_chunks(memory, challenge_id_ptr);
-
-  MerkleTree *merkle_tree = MerkleTree__new(config);
-  if (!merkle_tree) {
-    fprintf(stderr, "Error: Failed to allocate Merkle Tree.\n");
-    Memory__drop(memory);
+  // Solver posiada pamięć, drzewo Merkle i pulę wątków
+  SearchStats search_stats;
+  search_options.stats = &search_stats;
+  ItsukuSolver *solver = ItsukuSolver__new(config, &search_options);
+  if (!solver || !ItsukuSolver__prepare(solver, challenge_id_ptr,
+                                        config.difficulty_bits)) {
+    fprintf(stderr, "Error: Failed to allocate Memory and Merkle Tree.\n");
+    ItsukuSolver__drop(solver);
     ChallengeId__drop(challenge_id_ptr);
     free(challenge_id.bytes);
     return 1;
   }
-
-  // Budujemy Merkle Tree
-  MerkleTree__compute_leaf_hashes(merkle_tree, challenge_id_ptr, memory);
-  MerkleTree__compute_intermediate_nodes(merkle_tree, challenge_id_ptr);
+  MerkleTree *merkle_tree = solver->merkle_tree;
 
   // --- 3. Print Configuration (to stderr) ---
   const size_t total_elements_T = config.chunk_count * config.chunk_size;
@@ -325,22 +464,67 @@ int main(int argc, char *argv[]) {
   fprintf(stderr, "  Search Length (L): %zu\n", config.search_length);
   fprintf(stderr, "  Difficulty Bits (d): %zu\n", config.difficulty_bits);
   fprintf(stderr, "  Antecedents (n): %zu\n", config.antecedent_count);
+  fprintf(stderr, "  Search Threads: %zu\n",
+          SearchOptions__effective_thread_count(&search_options));
+  if (search_options.duty_cycle > 0 && search_options.duty_cycle < 1)
+    fprintf(stderr, "  Duty Cycle: %.0f%%\n",
+            search_options.duty_cycle * 100);
+  if (search_options.deadline_seconds > 0)
+    fprintf(stderr, "  Search Timeout: %.2f s\n",
+            search_options.deadline_seconds);
   print_hex(stderr, "  Challenge ID (I)", challenge_id_ptr->bytes,
             challenge_id_ptr->bytes_len);
   fprintf(stderr, "  Element Size: %d bytes\n", ITSUKU_ELEMENT_SIZE);
 
   // --- 4. Compute PoW Solution ---
   Proof *proof = NULL;
-  clock_t start_time = clock();
 
-  // Główna funkcja wyszukiwania
-  proof = Proof__search(config, challenge_id_ptr, memory, merkle_tree);
+  // Główna funkcja wyszukiwania (pamięć i drzewo są już zbudowane)
+  SearchResult search_result;
+  if (listen_path) {
+    // Robotnicy przeszukują zakres; dowód budujemy lokalnie ze zwycięzcy
+    WorkCoordinator *coordinator = WorkCoordinator__new(
+        listen_path, config, challenge_id_ptr, start_nonce, UINT64_MAX, 1,
+        ITSUKU_WORK_JOB_SIZE, &search_options);
+    if (!coordinator) {
+      fprintf(stderr, "Error: Failed to listen on %s.\n", listen_path);
+      ItsukuSolver__drop(solver);
+      ChallengeId__drop(challenge_id_ptr);
+      free(challenge_id.bytes);
+      return 1;
+    }
+    fprintf(stderr, "  Waiting for workers on %s\n", listen_path);
+    SearchStats__reset(&search_stats);
+    search_result = WorkCoordinator__run(coordinator);
+    WorkCoordinator__drop(coordinator);
+    atomic_store(&search_stats.nonces_evaluated, search_result.nonces_tried);
+    if (search_result.status == SearchStatus__Found)
+      search_result.proof =
+          Proof__from_nonce(&config, challenge_id_ptr, solver->memory,
+                            merkle_tree, search_result.last_nonce);
+  } else {
+    search_result = ItsukuSolver__solve_range(solver, challenge_id_ptr,
+                                              config.difficulty_bits,
+                                              start_nonce, UINT64_MAX, 1);
+  }
+  proof = search_result.proof;
+
+  // Rozwiązane wyzwanie nie potrzebuje już punktu kontrolnego
+  if (checkpoint_path && search_result.status == SearchStatus__Found) {
+    remove(checkpoint_path);
+  } else if (checkpoint_path && search_result.status != SearchStatus__Error) {
+    checkpoint_writer.checkpoint.next_nonce = search_result.last_nonce + 1;
+    if (!SearchCheckpoint__save(&checkpoint_writer.checkpoint,
+                                checkpoint_path))
+      fprintf(stderr, "Warning: Failed to write checkpoint %s.\n",
+              checkpoint_path);
+  }
 
-  clock_t end_time = clock();
-  double cpu_time_used = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+  // Czas ścienny (clock() sumuje czas CPU wszystkich wątków)
+  double wall_time = SearchStats__elapsed_seconds(&search_stats);
 
   // --- 5. Process and Serialize Results ---
-  VerificationError verify_result;
+  VerificationError verify_result = VerificationError__Ok;
   if (proof != NULL) {
     // Weryfikacja (opcjonalna, ale zalecana)
     verify_result = Proof__verify(proof);
@@ -348,7 +532,7 @@ int main(int argc, char *argv[]) {
     if (verify_result == VerificationError__Ok) {
       fprintf(stderr,
               "\n✅ PoW Search Successful and Verified in %.4f seconds.\n",
-              cpu_time_used);
+              wall_time);
 
       // Machine-friendly proof serialization to stdout
       size_t node_size = MerkleTree__calculate_node_size(&config);
@@ -359,15 +543,22 @@ int main(int argc, char *argv[]) {
       Proof__drop(proof);
       proof = NULL;
     }
+  } else if (search_result.status == SearchStatus__DeadlineExceeded) {
+    fprintf(stderr,
+            "\n⏱️  PoW Search Timed Out after %llu nonces (resume at %llu).\n",
+            (unsigned long long)search_result.nonces_tried,
+            (unsigned long long)(search_result.last_nonce + 1));
   } else {
     fprintf(stderr, "\n❌ PoW Search Failed (No nonce found).\n");
   }
 
+  fprintf(stderr, "\n📊 Search Statistics:\n");
+  SearchStats__print(&search_stats, stderr);
+
   // --- 6. Clean up allocated memory ---
   if (proof)
     Proof__drop(proof);
-  MerkleTree__drop(merkle_tree);
-  Memory__drop(memory);
+  ItsukuSolver__drop(solver);
   ChallengeId__drop(challenge_id_ptr); // Zwalnia również challenge_id.bytes
   free(challenge_id
            .bytes); // Zwalniamy tylko wskaźnik alokowany na początku.
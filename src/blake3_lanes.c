@@ -0,0 +1,153 @@
+#include "blake3_lanes.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define BLOCK_LEN 64
+
+#define CHUNK_START (1u << 0)
+#define CHUNK_END (1u << 1)
+#define ROOT (1u << 3)
+
+#define EACH_LANE for (size_t l = 0; l < BLAKE3_LANE_COUNT; ++l)
+
+static const uint32_t IV[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372,
+                               0xA54FF53A, 0x510E527F, 0x9B05688C,
+                               0x1F83D9AB, 0x5BE0CD19};
+
+static const uint8_t MSG_SCHEDULE[7][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+};
+
+/** One 32-bit word of every lane. */
+typedef uint32_t LaneWord[BLAKE3_LANE_COUNT];
+
+static inline uint32_t load_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+static inline void store_le32(uint8_t *p, uint32_t w) {
+  p[0] = (uint8_t)w;
+  p[1] = (uint8_t)(w >> 8);
+  p[2] = (uint8_t)(w >> 16);
+  p[3] = (uint8_t)(w >> 24);
+}
+
+static inline void g(LaneWord v[16], size_t a, size_t b, size_t c, size_t d,
+                     const LaneWord mx, const LaneWord my) {
+  EACH_LANE {
+    v[a][l] = v[a][l] + v[b][l] + mx[l];
+    v[d][l] ^= v[a][l];
+    v[d][l] = (v[d][l] >> 16) | (v[d][l] << 16);
+    v[c][l] = v[c][l] + v[d][l];
+    v[b][l] ^= v[c][l];
+    v[b][l] = (v[b][l] >> 12) | (v[b][l] << 20);
+    v[a][l] = v[a][l] + v[b][l] + my[l];
+    v[d][l] ^= v[a][l];
+    v[d][l] = (v[d][l] >> 8) | (v[d][l] << 24);
+    v[c][l] = v[c][l] + v[d][l];
+    v[b][l] ^= v[c][l];
+    v[b][l] = (v[b][l] >> 7) | (v[b][l] << 25);
+  }
+}
+
+/**
+ * @brief Runs the compression function on one block of every lane.
+ *
+ * Leaves the full 16-word state in `v`; the caller derives either the next
+ * chaining value or the root output from it. The block counter is always 0
+ * because every message fits in the first chunk.
+ */
+static void compress(LaneWord v[16], const LaneWord cv[8],
+                     const LaneWord m[16], uint32_t block_len,
+                     uint32_t flags) {
+  for (size_t i = 0; i < 8; ++i) {
+    EACH_LANE { v[i][l] = cv[i][l]; }
+  }
+  for (size_t i = 0; i < 4; ++i) {
+    EACH_LANE { v[8 + i][l] = IV[i]; }
+  }
+  EACH_LANE {
+    v[12][l] = 0;
+    v[13][l] = 0;
+    v[14][l] = block_len;
+    v[15][l] = flags;
+  }
+
+  for (size_t r = 0; r < 7; ++r) {
+    const uint8_t *s = MSG_SCHEDULE[r];
+    g(v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+    g(v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+    g(v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+    g(v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+    g(v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+    g(v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+    g(v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+    g(v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+  }
+}
+
+void Blake3Lanes__hash(const uint8_t *const inputs[], size_t input_len,
+                       size_t lane_count,
+                       uint8_t outputs[][BLAKE3_LANE_OUTPUT]) {
+  if (lane_count == 0 || lane_count > BLAKE3_LANE_COUNT ||
+      input_len > BLAKE3_LANE_MAX_INPUT)
+    return;
+
+  LaneWord cv[8];
+  LaneWord m[16];
+  LaneWord v[16];
+
+  for (size_t i = 0; i < 8; ++i) {
+    EACH_LANE { cv[i][l] = IV[i]; }
+  }
+
+  // An empty message is still compressed as one empty block
+  size_t block_count = input_len ? (input_len + BLOCK_LEN - 1) / BLOCK_LEN : 1;
+
+  for (size_t b = 0; b < block_count; ++b) {
+    size_t offset = b * BLOCK_LEN;
+    size_t block_len =
+        input_len - offset < BLOCK_LEN ? input_len - offset : BLOCK_LEN;
+    bool last = b + 1 == block_count;
+
+    // Unused lanes repeat lane 0 so the loops never branch per lane
+    for (size_t l = 0; l < BLAKE3_LANE_COUNT; ++l) {
+      const uint8_t *src = inputs[l < lane_count ? l : 0] + offset;
+      uint8_t padded[BLOCK_LEN];
+      if (block_len < BLOCK_LEN) {
+        memset(padded, 0, BLOCK_LEN);
+        memcpy(padded, src, block_len);
+        src = padded;
+      }
+      for (size_t i = 0; i < 16; ++i) {
+        m[i][l] = load_le32(src + 4 * i);
+      }
+    }
+
+    uint32_t flags = (b == 0 ? CHUNK_START : 0) |
+                     (last ? CHUNK_END | ROOT : 0);
+    compress(v, (const LaneWord *)cv, (const LaneWord *)m,
+             (uint32_t)block_len, flags);
+
+    if (last)
+      break;
+    for (size_t i = 0; i < 8; ++i) {
+      EACH_LANE { cv[i][l] = v[i][l] ^ v[i + 8][l]; }
+    }
+  }
+
+  // Root output block 0: the full 64-byte extended output
+  for (size_t l = 0; l < lane_count; ++l) {
+    for (size_t i = 0; i < 8; ++i) {
+      store_le32(&outputs[l][4 * i], v[i][l] ^ v[i + 8][l]);
+      store_le32(&outputs[l][32 + 4 * i], v[i + 8][l] ^ cv[i][l]);
+    }
+  }
+}
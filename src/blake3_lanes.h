@@ -0,0 +1,33 @@
+#ifndef BLAKE3_LANES_H
+#define BLAKE3_LANES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Number of messages hashed side by side. */
+#define BLAKE3_LANE_COUNT 8
+
+/** Longest message the lane hasher accepts: one BLAKE3 chunk. */
+#define BLAKE3_LANE_MAX_INPUT 1024
+
+/** Output size of the lane hasher (the 64-byte extended output). */
+#define BLAKE3_LANE_OUTPUT 64
+
+/**
+ * @brief Hashes up to BLAKE3_LANE_COUNT equal-length messages in lockstep.
+ *
+ * Each lane produces the same 64 bytes as blake3_hasher_finalize(..., 64)
+ * would for its message. State is kept as one array per word across lanes,
+ * so every step of the compression function is a plain loop over lanes that
+ * the compiler turns into SIMD code for the target it builds for.
+ *
+ * @param inputs lane_count message pointers, each input_len bytes long.
+ * @param input_len Message length; at most BLAKE3_LANE_MAX_INPUT.
+ * @param lane_count Number of lanes in use (1..BLAKE3_LANE_COUNT).
+ * @param outputs lane_count output buffers.
+ */
+void Blake3Lanes__hash(const uint8_t *const inputs[], size_t input_len,
+                       size_t lane_count,
+                       uint8_t outputs[][BLAKE3_LANE_OUTPUT]);
+
+#endif // BLAKE3_LANES_H
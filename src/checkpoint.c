@@ -0,0 +1,104 @@
+#include "checkpoint.h"
+#include "blake3.h"
+#include "memory.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECKPOINT_MAGIC "itsuku-checkpoint 1"
+
+static void hash_u64(blake3_hasher *hasher, uint64_t value) {
+  uint8_t bytes[8];
+  u64_to_le_bytes(value, bytes);
+  blake3_hasher_update(hasher, bytes, sizeof(bytes));
+}
+
+SearchCheckpoint SearchCheckpoint__new(const Config *config,
+                                       const ChallengeId *challenge_id,
+                                       uint64_t start, uint64_t stride) {
+  SearchCheckpoint self;
+  self.next_nonce = start;
+
+  blake3_hasher hasher;
+  blake3_hasher_init(&hasher);
+  blake3_hasher_update(&hasher, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC));
+  hash_u64(&hasher, config->chunk_size);
+  hash_u64(&hasher, config->chunk_count);
+  hash_u64(&hasher, config->antecedent_count);
+  hash_u64(&hasher, config->difficulty_bits);
+  hash_u64(&hasher, config->search_length);
+  hash_u64(&hasher, challenge_id->bytes_len);
+  blake3_hasher_update(&hasher, challenge_id->bytes, challenge_id->bytes_len);
+  hash_u64(&hasher, start);
+  hash_u64(&hasher, stride);
+  blake3_hasher_finalize(&hasher, self.key, SEARCH_CHECKPOINT_KEY_SIZE);
+  return self;
+}
+
+bool SearchCheckpoint__load(SearchCheckpoint *self, const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return false;
+
+  char magic[32] = {0};
+  char key_hex[2 * SEARCH_CHECKPOINT_KEY_SIZE + 1] = {0};
+  uint64_t next_nonce = 0;
+  bool parsed = fgets(magic, sizeof(magic), file) &&
+                strncmp(magic, CHECKPOINT_MAGIC "\n", sizeof(magic)) == 0 &&
+                fscanf(file, "key %64s\n", key_hex) == 1 &&
+                fscanf(file, "next_nonce %" SCNu64, &next_nonce) == 1;
+  fclose(file);
+  if (!parsed || strlen(key_hex) != 2 * SEARCH_CHECKPOINT_KEY_SIZE)
+    return false;
+
+  for (size_t i = 0; i < SEARCH_CHECKPOINT_KEY_SIZE; ++i) {
+    unsigned int byte;
+    if (sscanf(&key_hex[2 * i], "%2x", &byte) != 1 || byte != self->key[i])
+      return false;
+  }
+  self->next_nonce = next_nonce;
+  return true;
+}
+
+bool SearchCheckpoint__save(const SearchCheckpoint *self, const char *path) {
+  size_t path_len = strlen(path);
+  char *tmp_path = (char *)malloc(path_len + 5);
+  if (!tmp_path)
+    return false;
+  memcpy(tmp_path, path, path_len);
+  memcpy(&tmp_path[path_len], ".tmp", 5);
+
+  FILE *file = fopen(tmp_path, "w");
+  if (!file) {
+    free(tmp_path);
+    return false;
+  }
+  fprintf(file, CHECKPOINT_MAGIC "\nkey ");
+  for (size_t i = 0; i < SEARCH_CHECKPOINT_KEY_SIZE; ++i) {
+    fprintf(file, "%02x", self->key[i]);
+  }
+  fprintf(file, "\nnext_nonce %" PRIu64 "\n", self->next_nonce);
+
+  bool written = !ferror(file);
+  written = fclose(file) == 0 && written;
+  written = written && rename(tmp_path, path) == 0;
+  if (!written)
+    remove(tmp_path);
+  free(tmp_path);
+  return written;
+}
+
+void SearchCheckpointWriter__report(const SearchProgress *progress,
+                                    void *user_data) {
+  SearchCheckpointWriter *self = (SearchCheckpointWriter *)user_data;
+  if (progress->next_nonce > self->checkpoint.next_nonce &&
+      progress->elapsed_seconds - self->saved_at >= self->interval_seconds) {
+    self->checkpoint.next_nonce = progress->next_nonce;
+    if (SearchCheckpoint__save(&self->checkpoint, self->path))
+      self->saved_at = progress->elapsed_seconds;
+  }
+
+  if (self->next)
+    self->next(progress, self->next_user_data);
+}
@@ -0,0 +1,71 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "challenge_id.h"
+#include "config.h"
+#include "search.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Size in bytes of the key identifying the search a checkpoint belongs to. */
+#define SEARCH_CHECKPOINT_KEY_SIZE 32
+
+/**
+ * @brief Frontier of a nonce search that survives a restart.
+ *
+ * The key is a BLAKE3 hash of the Config, the challenge and the nonce
+ * sequence (start and stride), so a checkpoint is only ever applied to the
+ * search it was taken from. Every nonce of the sequence before next_nonce
+ * has been evaluated without success.
+ */
+typedef struct SearchCheckpoint {
+  uint8_t key[SEARCH_CHECKPOINT_KEY_SIZE];
+  uint64_t next_nonce;
+} SearchCheckpoint;
+
+/**
+ * @brief Periodic checkpoint writer, usable as a progress callback.
+ *
+ * Pass SearchCheckpointWriter__report as SearchOptions.progress and the
+ * writer as progress_user_data. Each report moves the frontier forward and
+ * rewrites the file at most once per `interval_seconds`; reports are then
+ * handed on to `next`, if any.
+ */
+typedef struct SearchCheckpointWriter {
+  SearchCheckpoint checkpoint;
+  const char *path;
+  double interval_seconds;
+  double saved_at; // elapsed_seconds of the last write
+  SearchProgressCallback next;
+  void *next_user_data;
+} SearchCheckpointWriter;
+
+/**
+ * @brief Creates the checkpoint of a fresh search of start, start + stride,
+ * ... for `challenge_id` under `config`.
+ */
+SearchCheckpoint SearchCheckpoint__new(const Config *config,
+                                       const ChallengeId *challenge_id,
+                                       uint64_t start, uint64_t stride);
+
+/**
+ * @brief Reads the frontier stored at `path` into `self`.
+ * @return true if the file exists, parses and carries the same key;
+ * otherwise `self` is left untouched.
+ */
+bool SearchCheckpoint__load(SearchCheckpoint *self, const char *path);
+
+/**
+ * @brief Writes the checkpoint to `path`, atomically replacing any previous
+ * one (the data goes to a temporary file that is then renamed).
+ * @return false on I/O failure.
+ */
+bool SearchCheckpoint__save(const SearchCheckpoint *self, const char *path);
+
+/**
+ * @brief Progress callback of a SearchCheckpointWriter.
+ */
+void SearchCheckpointWriter__report(const SearchProgress *progress,
+                                    void *user_data);
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,526 @@
+#define _POSIX_C_SOURCE 200809L // poll, clock_gettime
+
+#include "coordinator.h"
+#include "proof.h"
+#include "search_async.h"
+#include "solver.h"
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NO_JOB UINT64_MAX
+#define NO_NONCE UINT64_MAX
+#define POLL_INTERVAL_MS 20
+
+static double coordinator_monotonic_seconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Fills in a Unix-domain address for `path`.
+ * @return false if the path does not fit.
+ */
+static bool unix_address(const char *path, struct sockaddr_un *address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address->sun_path))
+    return false;
+  strcpy(address->sun_path, path);
+  return true;
+}
+
+// =================================================================
+// COORDINATOR
+// =================================================================
+
+WorkCoordinator *WorkCoordinator__new(const char *socket_path, Config config,
+                                      const ChallengeId *challenge_id,
+                                      uint64_t start, uint64_t end,
+                                      uint64_t stride, uint64_t job_size,
+                                      const SearchOptions *options) {
+  struct sockaddr_un address;
+  if (!unix_address(socket_path, &address) ||
+      challenge_id->bytes_len > WORK_CHALLENGE_MAX)
+    return NULL;
+
+  WorkCoordinator *self =
+      (WorkCoordinator *)calloc(1, sizeof(WorkCoordinator));
+  if (!self)
+    return NULL;
+  self->listen_fd = -1;
+  self->config = config;
+  self->start = start;
+  self->end = end;
+  self->stride = stride > 0 ? stride : 1;
+  self->job_size = job_size > 0 ? job_size : 1;
+  self->options = options ? *options : SearchOptions__default();
+  self->found_nonce = NO_NONCE;
+
+  uint64_t index_count =
+      end > start ? (end - start - 1) / self->stride + 1 : 0;
+  self->job_count = index_count / self->job_size +
+                    (index_count % self->job_size != 0);
+
+  self->challenge_id =
+      ChallengeId__new(challenge_id->bytes, challenge_id->bytes_len);
+  self->socket_path = (char *)malloc(strlen(socket_path) + 1);
+  if (!self->challenge_id || !self->socket_path) {
+    WorkCoordinator__drop(self);
+    return NULL;
+  }
+  strcpy(self->socket_path, socket_path);
+
+  unlink(socket_path);
+  self->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (self->listen_fd < 0 ||
+      bind(self->listen_fd, (struct sockaddr *)&address, sizeof(address)) !=
+          0 ||
+      listen(self->listen_fd, WORK_MAX_CONNECTIONS) != 0) {
+    WorkCoordinator__drop(self);
+    return NULL;
+  }
+  return self;
+}
+
+static uint64_t WorkCoordinator__job_first(const WorkCoordinator *self,
+                                           uint64_t job) {
+  return self->start + job * self->job_size * self->stride;
+}
+
+/**
+ * @brief Returns true if `job` may still hold a winner worth having.
+ */
+static bool WorkCoordinator__job_needed(const WorkCoordinator *self,
+                                        uint64_t job) {
+  if (self->found_nonce == NO_NONCE)
+    return true;
+  return self->options.lowest_nonce &&
+         WorkCoordinator__job_first(self, job) < self->found_nonce;
+}
+
+/**
+ * @brief Queues `job` to be handed out again, unless it no longer matters.
+ */
+static void WorkCoordinator__requeue(WorkCoordinator *self, uint64_t job) {
+  if (WorkCoordinator__job_needed(self, job) &&
+      self->retry_count < WORK_MAX_CONNECTIONS)
+    self->retry[self->retry_count++] = job;
+}
+
+/**
+ * @brief Takes the lowest job left to hand out, or NO_JOB.
+ */
+static uint64_t WorkCoordinator__take_job(WorkCoordinator *self) {
+  size_t lowest = self->retry_count;
+  for (size_t i = 0; i < self->retry_count; ++i) {
+    if (lowest == self->retry_count || self->retry[i] < self->retry[lowest])
+      lowest = i;
+  }
+  if (lowest < self->retry_count &&
+      WorkCoordinator__job_needed(self, self->retry[lowest])) {
+    uint64_t job = self->retry[lowest];
+    self->retry[lowest] = self->retry[--self->retry_count];
+    return job;
+  }
+
+  if (self->next_job < self->job_count &&
+      WorkCoordinator__job_needed(self, self->next_job))
+    return self->next_job++;
+  return NO_JOB;
+}
+
+static bool WorkCoordinator__send_job(WorkCoordinator *self,
+                                      WorkConnection *connection,
+                                      uint64_t job) {
+  uint64_t first = WorkCoordinator__job_first(self, job);
+  WorkMessage message = {
+      .type = WorkMessage__Job,
+      .job_id = job,
+      .config = self->config,
+      .start = first,
+      .end = job + 1 < self->job_count
+                 ? first + self->job_size * self->stride
+                 : self->end,
+      .stride = self->stride,
+      .share_difficulty_bits =
+          self->options.share ? self->options.share_difficulty_bits : 0,
+      .challenge_len = self->challenge_id->bytes_len,
+  };
+  memcpy(message.challenge, self->challenge_id->bytes,
+         self->challenge_id->bytes_len);
+  if (!WorkMessage__send(connection->fd, &message))
+    return false;
+
+  connection->job = job;
+  connection->waiting = false;
+  return true;
+}
+
+/**
+ * @brief Closes a connection; its unfinished job is handed out again.
+ */
+static void WorkCoordinator__close(WorkCoordinator *self, size_t index) {
+  WorkConnection *connection = &self->connections[index];
+  if (connection->job != NO_JOB)
+    WorkCoordinator__requeue(self, connection->job);
+  close(connection->fd);
+  self->connections[index] = self->connections[--self->connection_count];
+}
+
+/**
+ * @brief Applies one message from a worker.
+ * @return false if the worker broke the protocol.
+ */
+static bool WorkCoordinator__handle(WorkCoordinator *self,
+                                    WorkConnection *connection,
+                                    const WorkMessage *message) {
+  switch (message->type) {
+  case WorkMessage__Request:
+    connection->waiting = true;
+    return true;
+
+  case WorkMessage__Share:
+    if (self->options.share) {
+      SearchShare share = {.nonce = message->nonce,
+                           .leading_zeros = message->leading_zeros,
+                           .omega = NULL};
+      self->options.share(&share, self->options.share_user_data);
+    }
+    return true;
+
+  case WorkMessage__Result:
+    if (message->job_id != connection->job)
+      return false;
+    self->nonces_tried += message->nonces_tried;
+    if (message->status == SearchStatus__Found) {
+      if (message->nonce < self->found_nonce)
+        self->found_nonce = message->nonce;
+    } else if (message->status != SearchStatus__NotFoundInRange) {
+      WorkCoordinator__requeue(self, connection->job);
+    }
+    connection->job = NO_JOB;
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+/**
+ * @brief Reads what a worker sent and applies every complete message.
+ * @return false if the connection is to be closed.
+ */
+static bool WorkCoordinator__receive(WorkCoordinator *self,
+                                     WorkConnection *connection) {
+  ssize_t n = read(connection->fd, &connection->buffer[connection->len],
+                   sizeof(connection->buffer) - connection->len);
+  if (n < 0 && errno == EINTR)
+    return true;
+  if (n <= 0)
+    return false;
+  connection->len += (size_t)n;
+
+  for (;;) {
+    WorkMessage message;
+    long frame = WorkMessage__decode(connection->buffer, connection->len,
+                                     &message);
+    if (frame < 0)
+      return false;
+    if (frame == 0)
+      return true;
+    if (!WorkCoordinator__handle(self, connection, &message))
+      return false;
+    connection->len -= (size_t)frame;
+    memmove(connection->buffer, &connection->buffer[frame], connection->len);
+  }
+}
+
+/**
+ * @brief Returns true once no outstanding job can change the result.
+ */
+static bool WorkCoordinator__decided(const WorkCoordinator *self) {
+  if (self->found_nonce != NO_NONCE && !self->options.lowest_nonce)
+    return true;
+
+  for (size_t i = 0; i < self->retry_count; ++i) {
+    if (WorkCoordinator__job_needed(self, self->retry[i]))
+      return false;
+  }
+  for (size_t i = 0; i < self->connection_count; ++i) {
+    uint64_t job = self->connections[i].job;
+    if (job != NO_JOB && WorkCoordinator__job_needed(self, job))
+      return false;
+  }
+  return self->next_job >= self->job_count ||
+         !WorkCoordinator__job_needed(self, self->next_job);
+}
+
+/**
+ * @brief Returns the lowest job that has not been reported, so every nonce
+ * before its first one has been searched.
+ */
+static uint64_t WorkCoordinator__frontier(const WorkCoordinator *self) {
+  uint64_t frontier = self->next_job;
+  for (size_t i = 0; i < self->retry_count; ++i) {
+    if (self->retry[i] < frontier)
+      frontier = self->retry[i];
+  }
+  for (size_t i = 0; i < self->connection_count; ++i) {
+    if (self->connections[i].job < frontier)
+      frontier = self->connections[i].job;
+  }
+  return frontier;
+}
+
+SearchResult WorkCoordinator__run(WorkCoordinator *self) {
+  // An empty range is exhausted before any worker is served
+  if (self->end <= self->start) {
+    return (SearchResult){.status = SearchStatus__NotFoundInRange,
+                          .proof = NULL,
+                          .last_nonce = self->start - self->stride};
+  }
+
+  double deadline_at =
+      self->options.deadline_seconds > 0
+          ? coordinator_monotonic_seconds() + self->options.deadline_seconds
+          : 0;
+  SearchStatus halt = SearchStatus__NotFoundInRange;
+
+  while (!WorkCoordinator__decided(self)) {
+    if (self->options.cancel_flag && atomic_load(self->options.cancel_flag)) {
+      halt = SearchStatus__Cancelled;
+      break;
+    }
+    if (deadline_at > 0 && coordinator_monotonic_seconds() >= deadline_at) {
+      halt = SearchStatus__DeadlineExceeded;
+      break;
+    }
+
+    struct pollfd fds[WORK_MAX_CONNECTIONS + 1];
+    fds[0] = (struct pollfd){.fd = self->listen_fd, .events = POLLIN};
+    for (size_t i = 0; i < self->connection_count; ++i) {
+      fds[i + 1] =
+          (struct pollfd){.fd = self->connections[i].fd, .events = POLLIN};
+    }
+    size_t polled = self->connection_count;
+    if (poll(fds, polled + 1, POLL_INTERVAL_MS) < 0 && errno != EINTR)
+      break;
+
+    // Walk backwards: closing a connection moves the last one into its slot
+    for (size_t i = polled; i-- > 0;) {
+      if (fds[i + 1].revents &&
+          !WorkCoordinator__receive(self, &self->connections[i]))
+        WorkCoordinator__close(self, i);
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int fd = accept(self->listen_fd, NULL, NULL);
+      if (fd >= 0 && self->connection_count < WORK_MAX_CONNECTIONS) {
+        WorkConnection *connection =
+            &self->connections[self->connection_count++];
+        connection->fd = fd;
+        connection->len = 0;
+        connection->job = NO_JOB;
+        connection->waiting = false;
+      } else if (fd >= 0) {
+        close(fd);
+      }
+    }
+
+    for (size_t i = self->connection_count; i-- > 0;) {
+      WorkConnection *connection = &self->connections[i];
+      if (!connection->waiting)
+        continue;
+      uint64_t job = WorkCoordinator__take_job(self);
+      if (job == NO_JOB)
+        break;
+      if (!WorkCoordinator__send_job(self, connection, job)) {
+        WorkCoordinator__requeue(self, job);
+        WorkCoordinator__close(self, i);
+      }
+    }
+  }
+
+  SearchResult result = {.status = halt,
+                         .proof = NULL,
+                         .nonces_tried = self->nonces_tried};
+  if (self->found_nonce != NO_NONCE && WorkCoordinator__decided(self)) {
+    result.status = SearchStatus__Found;
+    result.last_nonce = self->found_nonce;
+  } else {
+    uint64_t frontier = WorkCoordinator__frontier(self);
+    result.last_nonce =
+        frontier < self->job_count
+            ? WorkCoordinator__job_first(self, frontier) - self->stride
+            : self->start +
+                  ((self->end - self->start - 1) / self->stride) *
+                      self->stride;
+  }
+
+  WorkMessage stop = {.type = WorkMessage__Stop};
+  while (self->connection_count > 0) {
+    WorkMessage__send(self->connections[0].fd, &stop);
+    self->connections[0].job = NO_JOB;
+    WorkCoordinator__close(self, 0);
+  }
+  return result;
+}
+
+void WorkCoordinator__drop(WorkCoordinator *self) {
+  if (!self)
+    return;
+  for (size_t i = 0; i < self->connection_count; ++i) {
+    close(self->connections[i].fd);
+  }
+  if (self->listen_fd >= 0) {
+    close(self->listen_fd);
+    unlink(self->socket_path);
+  }
+  free(self->socket_path);
+  ChallengeId__drop(self->challenge_id);
+  free(self);
+}
+
+// =================================================================
+// WORKER
+// =================================================================
+
+/**
+ * @brief Share sink of a worker: forwards shares of the current job.
+ */
+typedef struct WorkShareSink {
+  int fd;
+  uint64_t job_id;
+} WorkShareSink;
+
+static void WorkShareSink__report(const SearchShare *share, void *user_data) {
+  WorkShareSink *sink = (WorkShareSink *)user_data;
+  WorkMessage message = {.type = WorkMessage__Share,
+                         .job_id = sink->job_id,
+                         .nonce = share->nonce,
+                         .leading_zeros = share->leading_zeros};
+  WorkMessage__send(sink->fd, &message);
+}
+
+static bool same_layout(const Config *a, const Config *b) {
+  return a->chunk_size == b->chunk_size && a->chunk_count == b->chunk_count &&
+         a->antecedent_count == b->antecedent_count &&
+         a->search_length == b->search_length;
+}
+
+/**
+ * @brief Searches one job in the background while watching the socket.
+ * @return false once the coordinator said stop (`*stopped` is set) or the
+ * connection is gone.
+ */
+static bool WorkWorker__search(int fd, ItsukuSolver *solver,
+                               const WorkMessage *job,
+                               const ChallengeId *challenge_id,
+                               const SearchOptions *options,
+                               WorkMessage *report, bool *stopped) {
+  WorkShareSink sink = {.fd = fd, .job_id = job->job_id};
+  SearchOptions job_options = *options;
+  job_options.share_difficulty_bits = job->share_difficulty_bits;
+  job_options.share =
+      job->share_difficulty_bits > 0 ? WorkShareSink__report : NULL;
+  job_options.share_user_data = &sink;
+
+  SearchHandle *handle = Proof__search_async_in(
+      solver->workspace, job->config, challenge_id, solver->memory,
+      solver->merkle_tree, job->start, job->end, job->stride, &job_options);
+  if (!handle)
+    return false;
+
+  bool connected = true;
+  while (!SearchHandle__poll(handle)) {
+    struct pollfd pfd = {.fd = fd, .events = POLLIN};
+    if (poll(&pfd, 1, POLL_INTERVAL_MS) <= 0)
+      continue;
+
+    // The only thing a coordinator sends mid-job is Stop
+    WorkMessage message = {0};
+    connected = WorkMessage__recv(fd, &message) &&
+                message.type != WorkMessage__Stop;
+    if (!connected) {
+      *stopped = message.type == WorkMessage__Stop;
+      SearchHandle__cancel(handle);
+      break;
+    }
+  }
+
+  SearchResult result = SearchHandle__take_result(handle);
+  Proof__drop(result.proof);
+  SearchHandle__drop(handle);
+
+  *report = (WorkMessage){.type = WorkMessage__Result,
+                          .job_id = job->job_id,
+                          .status = result.status,
+                          .nonce = result.last_nonce,
+                          .nonces_tried = result.nonces_tried};
+  return connected;
+}
+
+bool WorkWorker__run(const char *socket_path, const SearchOptions *options) {
+  struct sockaddr_un address;
+  if (!unix_address(socket_path, &address))
+    return false;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return false;
+  if (connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+    close(fd);
+    return false;
+  }
+
+  SearchOptions defaults = SearchOptions__default();
+  if (!options)
+    options = &defaults;
+  ItsukuSolver *solver = NULL;
+  bool stopped = false;
+  WorkMessage request = {.type = WorkMessage__Request};
+
+  while (WorkMessage__send(fd, &request)) {
+    WorkMessage job;
+    if (!WorkMessage__recv(fd, &job))
+      break;
+    if (job.type == WorkMessage__Stop) {
+      stopped = true;
+      break;
+    }
+    if (job.type != WorkMessage__Job)
+      break;
+
+    if (solver && !same_layout(&solver->config, &job.config)) {
+      ItsukuSolver__drop(solver);
+      solver = NULL;
+    }
+    if (!solver)
+      solver = ItsukuSolver__new(job.config, options);
+    ChallengeId *challenge_id =
+        ChallengeId__new(job.challenge, job.challenge_len);
+    if (!solver || !challenge_id ||
+        !ItsukuSolver__prepare(solver, challenge_id,
+                               job.config.difficulty_bits)) {
+      ChallengeId__drop(challenge_id);
+      break;
+    }
+
+    WorkMessage report;
+    bool connected = WorkWorker__search(fd, solver, &job, challenge_id,
+                                        options, &report, &stopped);
+    ChallengeId__drop(challenge_id);
+    if (!connected || !WorkMessage__send(fd, &report))
+      break;
+  }
+
+  ItsukuSolver__drop(solver);
+  close(fd);
+  return stopped;
+}
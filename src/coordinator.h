@@ -0,0 +1,105 @@
+#ifndef COORDINATOR_H
+#define COORDINATOR_H
+
+#include "challenge_id.h"
+#include "config.h"
+#include "search.h"
+#include "work_protocol.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Most workers a coordinator serves at once. */
+#define WORK_MAX_CONNECTIONS 64
+
+/**
+ * @brief A worker connected to the coordinator.
+ */
+typedef struct WorkConnection {
+  int fd;
+  /** Bytes received but not yet decoded. */
+  uint8_t buffer[WORK_FRAME_MAX];
+  size_t len;
+  /** Index of the job in progress, or UINT64_MAX when idle. */
+  uint64_t job;
+  /** True while the worker waits for a job. */
+  bool waiting;
+} WorkConnection;
+
+/**
+ * @brief Hands out the nonce range of one challenge to solver workers over
+ * a Unix-domain socket.
+ *
+ * The range is cut into jobs of `job_size` nonces, handed out in order.
+ * The jobs of a worker that disconnects before reporting are handed out
+ * again. In lowest-nonce mode the coordinator only finishes once every job
+ * below the best winner has been reported, so the result does not depend
+ * on how the jobs were spread.
+ */
+typedef struct WorkCoordinator {
+  int listen_fd;
+  char *socket_path;
+
+  Config config;
+  ChallengeId *challenge_id;
+  uint64_t start;
+  uint64_t end;
+  uint64_t stride;
+  uint64_t job_size;
+  uint64_t job_count;
+  uint64_t next_job;
+  SearchOptions options;
+
+  /** Jobs of vanished workers, to be handed out again. */
+  uint64_t retry[WORK_MAX_CONNECTIONS];
+  size_t retry_count;
+  WorkConnection connections[WORK_MAX_CONNECTIONS];
+  size_t connection_count;
+
+  uint64_t found_nonce; // UINT64_MAX while nothing has been found
+  uint64_t nonces_tried;
+} WorkCoordinator;
+
+/**
+ * @brief Listens on `socket_path` (replacing a stale socket file) for
+ * workers searching start, start + stride, ... below end in jobs of
+ * `job_size` nonces.
+ *
+ * Of `options` (NULL selects the defaults) lowest_nonce, cancel_flag,
+ * deadline_seconds and the share settings apply; shares reported by
+ * workers reach the callback without their Omega (omega is NULL).
+ * @return The coordinator, or NULL on failure.
+ */
+WorkCoordinator *WorkCoordinator__new(const char *socket_path, Config config,
+                                      const ChallengeId *challenge_id,
+                                      uint64_t start, uint64_t end,
+                                      uint64_t stride, uint64_t job_size,
+                                      const SearchOptions *options);
+
+/**
+ * @brief Serves workers until the search is decided, then tells them all to
+ * stop.
+ * @return Found with the winner in last_nonce (result.proof is NULL; build
+ * it with Proof__from_nonce), or why the search ended without one.
+ * nonces_tried counts the nonces reported by workers.
+ */
+SearchResult WorkCoordinator__run(WorkCoordinator *self);
+
+/**
+ * @brief Closes all connections and removes the socket file. Safe to call
+ * with NULL.
+ */
+void WorkCoordinator__drop(WorkCoordinator *self);
+
+/**
+ * @brief Connects to the coordinator at `socket_path` and searches the jobs
+ * it hands out until told to stop.
+ *
+ * Memory and tree are built by an ItsukuSolver with `options` and reused
+ * while jobs keep the same challenge.
+ * @return true if the coordinator ended the session, false if the
+ * connection failed or was lost.
+ */
+bool WorkWorker__run(const char *socket_path, const SearchOptions *options);
+
+#endif // COORDINATOR_H
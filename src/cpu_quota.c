@@ -0,0 +1,110 @@
+#define _GNU_SOURCE // sched_getaffinity, CPU_COUNT
+
+#include "cpu_quota.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CGROUP_ROOT "/sys/fs/cgroup"
+#define CGROUP_PATH_MAX 4096
+
+bool CpuQuota__parse_cpu_max(const char *text, double *quota_cpus) {
+  char quota[32];
+  unsigned long long period;
+  if (sscanf(text, "%31s %llu", quota, &period) != 2 || period == 0)
+    return false;
+  if (strcmp(quota, "max") == 0) {
+    *quota_cpus = 0.0;
+    return true;
+  }
+
+  char *end;
+  unsigned long long limit = strtoull(quota, &end, 10);
+  if (*end != '\0' || limit == 0)
+    return false;
+  *quota_cpus = (double)limit / (double)period;
+  return true;
+}
+
+static size_t available_cpus() {
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) > 0)
+    return (size_t)CPU_COUNT(&set);
+
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  return online > 0 ? (size_t)online : 1;
+}
+
+/**
+ * @brief Reads the `cpu.max` of one cgroup directory.
+ * @return The quota in CPUs, or 0 if unlimited or unreadable.
+ */
+static double read_cpu_max(const char *directory) {
+  char path[CGROUP_PATH_MAX + 16];
+  snprintf(path, sizeof(path), "%s/cpu.max", directory);
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return 0.0;
+
+  char line[128];
+  double quota_cpus = 0.0;
+  if (!fgets(line, sizeof(line), file) ||
+      !CpuQuota__parse_cpu_max(line, &quota_cpus))
+    quota_cpus = 0.0;
+  fclose(file);
+  return quota_cpus;
+}
+
+CpuQuota CpuQuota__read(const char *cgroup_root, const char *cgroup_path) {
+  CpuQuota self = {.available_cpus = available_cpus(), .quota_cpus = 0.0};
+
+  char directory[CGROUP_PATH_MAX];
+  int len = snprintf(directory, sizeof(directory), "%s%s", cgroup_root,
+                     cgroup_path);
+  if (len < 0 || (size_t)len >= sizeof(directory))
+    return self;
+  size_t root_len = strlen(cgroup_root);
+
+  // A parent's limit caps all of its children, so take the tightest one
+  for (;;) {
+    double quota_cpus = read_cpu_max(directory);
+    if (quota_cpus > 0 &&
+        (self.quota_cpus == 0 || quota_cpus < self.quota_cpus))
+      self.quota_cpus = quota_cpus;
+
+    char *slash = strrchr(directory, '/');
+    if (!slash || (size_t)(slash - directory) < root_len)
+      break;
+    *slash = '\0';
+  }
+  return self;
+}
+
+CpuQuota CpuQuota__detect() {
+  // The cgroup v2 entry of /proc/self/cgroup reads "0::/path"
+  char line[CGROUP_PATH_MAX];
+  char cgroup_path[CGROUP_PATH_MAX] = "";
+  FILE *file = fopen("/proc/self/cgroup", "r");
+  if (file) {
+    while (fgets(line, sizeof(line), file)) {
+      if (strncmp(line, "0::", 3) == 0) {
+        line[strcspn(line, "\n")] = '\0';
+        strcpy(cgroup_path, &line[3]);
+        break;
+      }
+    }
+    fclose(file);
+  }
+  if (strcmp(cgroup_path, "/") == 0)
+    cgroup_path[0] = '\0';
+  return CpuQuota__read(CGROUP_ROOT, cgroup_path);
+}
+
+double CpuQuota__budget(const CpuQuota *self) {
+  double budget = (double)self->available_cpus;
+  if (self->quota_cpus > 0 && self->quota_cpus < budget)
+    budget = self->quota_cpus;
+  return budget;
+}
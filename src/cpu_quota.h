@@ -0,0 +1,50 @@
+#ifndef CPU_QUOTA_H
+#define CPU_QUOTA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief CPU capacity the process may actually use.
+ *
+ * A container limited by cgroup v2 `cpu.max` still sees every CPU of the
+ * host; a pool sized from the online CPU count then burns its quota early
+ * in each period and is throttled for the rest of it. The budget of a
+ * process is the smaller of its CPU affinity and the tightest `cpu.max`
+ * from its cgroup up to the root of the hierarchy.
+ */
+typedef struct CpuQuota {
+  /** CPUs the process may be scheduled on. */
+  size_t available_cpus;
+  /** CPU time per period allowed by cpu.max, in CPUs; 0 when unlimited. */
+  double quota_cpus;
+} CpuQuota;
+
+/**
+ * @brief Parses the contents of a cgroup v2 `cpu.max` file ("QUOTA PERIOD"
+ * or "max PERIOD").
+ * @return true on success, with `*quota_cpus` set to QUOTA / PERIOD, or 0
+ * for "max".
+ */
+bool CpuQuota__parse_cpu_max(const char *text, double *quota_cpus);
+
+/**
+ * @brief Reads the quota of the cgroup at `cgroup_path` (as listed in
+ * /proc/self/cgroup) below the hierarchy mounted at `cgroup_root`,
+ * together with the CPUs available to the process.
+ */
+CpuQuota CpuQuota__read(const char *cgroup_root, const char *cgroup_path);
+
+/**
+ * @brief Reads the quota of the calling process from /sys/fs/cgroup. Hosts
+ * without cgroup v2 report no quota.
+ */
+CpuQuota CpuQuota__detect();
+
+/**
+ * @brief Returns the budget in CPUs: the available CPUs, capped by the
+ * quota.
+ */
+double CpuQuota__budget(const CpuQuota *self);
+
+#endif // CPU_QUOTA_H
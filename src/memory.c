@@ -249,41 +249,73 @@ void Memory__build_all_chunks(Memory *self, const ChallengeId *challenge_id) {
   }
 }
 
-size_t Memory__trace_element(const Memory *self, size_t leaf_index,
-                             Element **out_antecedents) {
+size_t Memory__copy_antecedents(const Memory *self, size_t leaf_index,
+                                Element *out_antecedents) {
   size_t antecedent_count = self->config.antecedent_count;
 
   size_t chunk_index = leaf_index / self->config.chunk_size;
   if (chunk_index >= self->config.chunk_count)
     return 0;
-  Element *chunk = self->chunks[chunk_index];
+  const Element *chunk = self->chunks[chunk_index];
 
   size_t element_index = leaf_index % self->config.chunk_size;
 
   if (element_index < antecedent_count) {
-    *out_antecedents = (Element *)malloc(sizeof(Element));
-    if (!*out_antecedents)
-      return 0;
-    (*out_antecedents)[0] = chunk[element_index];
+    out_antecedents[0] = chunk[element_index];
     return 1;
   }
 
-  size_t *indices = (size_t *)malloc(antecedent_count * sizeof(size_t));
-  if (!indices)
-    return 0;
-
+  size_t indices[antecedent_count];
   Memory__get_antecedent_indices(&self->config, chunk, element_index, indices);
 
+  for (size_t i = 0; i < antecedent_count; ++i) {
+    out_antecedents[i] = chunk[indices[i]];
+  }
+  return antecedent_count;
+}
+
+size_t Memory__trace_element(const Memory *self, size_t leaf_index,
+                             Element **out_antecedents) {
+  size_t antecedent_count = self->config.antecedent_count;
+
+  if (leaf_index / self->config.chunk_size >= self->config.chunk_count)
+    return 0;
+
   *out_antecedents = (Element *)malloc(antecedent_count * sizeof(Element));
-  if (!*out_antecedents) {
-    free(indices);
+  if (!*out_antecedents)
     return 0;
-  }
 
-  for (size_t i = 0; i < antecedent_count; ++i) {
-    (*out_antecedents)[i] = chunk[indices[i]];
+  return Memory__copy_antecedents(self, leaf_index, *out_antecedents);
+}
+
+/**
+ * @brief Retrieves a copy of an Element from full memory.
+ *
+ * Used by the nonce search to simulate MemoryType::get_element.
+ */
+static Element Memory__get_element_copy(void *data, size_t index) {
+  const Memory *mem = (const Memory *)data;
+  const Element *elem_ptr = Memory__get((Memory *)mem, index);
+  if (elem_ptr) {
+    return *elem_ptr;
   }
+  return Element__zero();
+}
 
-  free(indices);
-  return antecedent_count;
+static void Memory__prefetch_element(void *data, size_t index) {
+  const Element *elem_ptr = Memory__get((Memory *)data, index);
+#if defined(__GNUC__)
+  if (elem_ptr)
+    __builtin_prefetch(elem_ptr);
+#else
+  (void)elem_ptr;
+#endif
+}
+
+PartialMemory_Wrapper Memory__as_partial(const Memory *self) {
+  return (PartialMemory_Wrapper){
+      .data = (void *)self,
+      .get_element = Memory__get_element_copy,
+      .prefetch_element = Memory__prefetch_element,
+  };
 }
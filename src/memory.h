@@ -126,6 +126,15 @@ void Memory__build_all_chunks(Memory *self, const ChallengeId *challenge_id);
 size_t Memory__trace_element(const Memory *self, size_t leaf_index,
                              Element **out_antecedents);
 
+/**
+ * @brief Copies the antecedent elements of a leaf into a caller buffer.
+ * @param out_antecedents Output array of at least antecedent_count Elements.
+ * @return Number of antecedents copied (1 for base element, antecedent_count
+ * otherwise), or 0 if leaf_index is out of range.
+ */
+size_t Memory__copy_antecedents(const Memory *self, size_t leaf_index,
+                                Element *out_antecedents);
+
 /**
  * @brief Converts a uint64_t to 8 bytes in Little Endian order.
  */
@@ -144,6 +153,18 @@ uint64_t u64_from_le_bytes(const uint8_t bytes[8]);
 typedef struct PartialMemory_Wrapper {
   void *data;
   Element (*get_element)(void *data, size_t index);
+  /**
+   * Optional hint that `index` will be read soon; NULL when the backing
+   * store has nothing to prefetch.
+   */
+  void (*prefetch_element)(void *data, size_t index);
 } PartialMemory_Wrapper;
 
+/**
+ * @brief Wraps a full Memory in the PartialMemory interface.
+ *
+ * Out-of-range indices read as a zero Element.
+ */
+PartialMemory_Wrapper Memory__as_partial(const Memory *self);
+
 #endif // MEMORY_H
@@ -1,3 +1,5 @@
+#define _POSIX_C_SOURCE 200112L // posix_memalign
+
 #include "merkle_tree.h"
 #include "memory.h"
 #include <blake3.h>
@@ -26,27 +28,54 @@ size_t MerkleTree__calculate_node_size(const Config *config) {
 }
 
 MerkleTree *MerkleTree__new(Config config) {
+  return MerkleTree__new_with_stride(config, 0);
+}
+
+MerkleTree *MerkleTree__new_with_stride(Config config, size_t alignment) {
+  if (alignment > 1 && (alignment & (alignment - 1)) != 0)
+    return NULL;
+
   MerkleTree *tree = (MerkleTree *)malloc(sizeof(MerkleTree));
   if (!tree)
     return NULL;
 
   tree->config = config;
   tree->node_size = MerkleTree__calculate_node_size(&config);
+  tree->node_stride = tree->node_size;
+  if (alignment > 1) {
+    tree->node_stride = (tree->node_size + alignment - 1) & ~(alignment - 1);
+  }
 
   size_t total_elements = config.chunk_count * config.chunk_size;
   size_t nodes_count = 2 * total_elements - 1;
-  size_t total_bytes = nodes_count * tree->node_size;
-
-  tree->nodes = (uint8_t *)calloc(total_bytes, 1);
-  if (!tree->nodes) {
-    free(tree);
-    return NULL;
+  size_t total_bytes = nodes_count * tree->node_stride;
+
+  if (alignment > 1) {
+    void *nodes = NULL;
+    size_t buffer_alignment =
+        alignment < sizeof(void *) ? sizeof(void *) : alignment;
+    if (posix_memalign(&nodes, buffer_alignment, total_bytes) != 0) {
+      free(tree);
+      return NULL;
+    }
+    memset(nodes, 0, total_bytes);
+    tree->nodes = (uint8_t *)nodes;
+  } else {
+    tree->nodes = (uint8_t *)calloc(total_bytes, 1);
+    if (!tree->nodes) {
+      free(tree);
+      return NULL;
+    }
   }
   tree->nodes_len = total_bytes;
 
   return tree;
 }
 
+size_t MerkleTree__node_count(const MerkleTree *self) {
+  return self->nodes_len / self->node_stride;
+}
+
 void MerkleTree__drop(MerkleTree *self) {
   if (self) {
     free(self->nodes);
@@ -55,15 +84,15 @@ void MerkleTree__drop(MerkleTree *self) {
 }
 
 static uint8_t *MerkleTree__get_node_mut(MerkleTree *self, size_t index) {
-  size_t offset = index * self->node_size;
-  if (offset + self->node_size > self->nodes_len)
+  size_t offset = index * self->node_stride;
+  if (offset + self->node_stride > self->nodes_len)
     return NULL;
   return &self->nodes[offset];
 }
 
 const uint8_t *MerkleTree__get_node(const MerkleTree *self, size_t index) {
-  size_t offset = index * self->node_size;
-  if (offset + self->node_size > self->nodes_len)
+  size_t offset = index * self->node_stride;
+  if (offset + self->node_stride > self->nodes_len)
     return NULL;
   return &self->nodes[offset];
 }
@@ -86,12 +115,21 @@ void MerkleTree__compute_leaf_hash(const ChallengeId *challenge_id,
 void MerkleTree__compute_leaf_hashes(MerkleTree *self,
                                      const ChallengeId *challenge_id,
                                      const Memory *memory) {
+  MerkleTree__compute_leaf_range(self, challenge_id, memory, 0,
+                                 self->config.chunk_count *
+                                     self->config.chunk_size);
+}
+
+void MerkleTree__compute_leaf_range(MerkleTree *self,
+                                    const ChallengeId *challenge_id,
+                                    const Memory *memory, size_t begin,
+                                    size_t end) {
   size_t element_count =
       self->config.chunk_count * self->config.chunk_size;
   size_t node_size = self->node_size;
   size_t first_leaf = element_count - 1;
 
-  for (size_t i = 0; i < element_count; ++i) {
+  for (size_t i = begin; i < end && i < element_count; ++i) {
     size_t node_index = first_leaf + i;
 
     const Element *element = Memory__get((Memory *)memory, i);
@@ -112,6 +150,20 @@ void MerkleTree__children_of(size_t index, size_t *left_index,
   *right_index = 2 * index + 2;
 }
 
+void MerkleTree__compute_parent_hash(const ChallengeId *challenge_id,
+                                     const uint8_t *left_node,
+                                     const uint8_t *right_node,
+                                     size_t node_size, uint8_t *output) {
+  blake3_hasher hasher;
+  blake3_hasher_init(&hasher);
+
+  blake3_hasher_update(&hasher, left_node, node_size);
+  blake3_hasher_update(&hasher, right_node, node_size);
+  blake3_hasher_update(&hasher, challenge_id->bytes, challenge_id->bytes_len);
+
+  blake3_hasher_finalize(&hasher, output, node_size);
+}
+
 void MerkleTree__compute_intermediate_nodes(MerkleTree *self,
                                             const ChallengeId *challenge_id) {
   size_t total_elements =
@@ -130,14 +182,8 @@ void MerkleTree__compute_intermediate_nodes(MerkleTree *self,
     if (!left_node || !right_node || !parent_node)
       return;
 
-    blake3_hasher hasher;
-    blake3_hasher_init(&hasher);
-
-    blake3_hasher_update(&hasher, left_node, node_size);
-    blake3_hasher_update(&hasher, right_node, node_size);
-    blake3_hasher_update(&hasher, challenge_id->bytes, challenge_id->bytes_len);
-
-    blake3_hasher_finalize(&hasher, parent_node, node_size);
+    MerkleTree__compute_parent_hash(challenge_id, left_node, right_node,
+                                    node_size, parent_node);
   }
 
   if (total_elements > 0) {
@@ -151,14 +197,8 @@ void MerkleTree__compute_intermediate_nodes(MerkleTree *self,
     if (!left_node || !right_node || !root_node)
       return;
 
-    blake3_hasher hasher;
-    blake3_hasher_init(&hasher);
-
-    blake3_hasher_update(&hasher, left_node, node_size);
-    blake3_hasher_update(&hasher, right_node, node_size);
-    blake3_hasher_update(&hasher, challenge_id->bytes, challenge_id->bytes_len);
-
-    blake3_hasher_finalize(&hasher, root_node, node_size);
+    MerkleTree__compute_parent_hash(challenge_id, left_node, right_node,
+                                    node_size, root_node);
   }
 }
 
@@ -176,8 +216,7 @@ static void MerkleTree__insert_node_copy(const MerkleTree *self, HashMap nodes,
 
 void MerkleTree__trace_node(const MerkleTree *self, size_t index,
                             HashMap nodes) {
-  size_t total_nodes = self->nodes_len / self->node_size;
-  if (index >= total_nodes)
+  if (index >= MerkleTree__node_count(self))
     return;
 
   MerkleTree__insert_node_copy(self, nodes, index);
@@ -191,3 +230,119 @@ void MerkleTree__trace_node(const MerkleTree *self, size_t index,
   size_t parent_index = (index - 1) / 2;
   MerkleTree__trace_node(self, parent_index, nodes);
 }
+
+static int compare_size_t_desc(const void *a, const void *b) {
+  size_t lhs = *(const size_t *)a;
+  size_t rhs = *(const size_t *)b;
+  return (lhs < rhs) - (lhs > rhs);
+}
+
+bool MerkleTree__multiproof_indices(const size_t *leaf_node_indices,
+                                    size_t leaf_count, size_t *out_indices,
+                                    size_t *out_count) {
+  *out_count = 0;
+  if (leaf_count == 0)
+    return true;
+
+  // Known nodes are consumed in descending index order from two sources: the
+  // sorted leaves and the queue of derived parents. A parent is always smaller
+  // than its children, so parents are produced in non-increasing order and
+  // the queue stays sorted without further work. At most leaf_count nodes are
+  // pending at any time, so the queue is a ring buffer of that size.
+  size_t *leaves = (size_t *)malloc(leaf_count * sizeof(size_t));
+  size_t *parents = (size_t *)malloc(leaf_count * sizeof(size_t));
+  if (!leaves || !parents) {
+    free(leaves);
+    free(parents);
+    return false;
+  }
+  memcpy(leaves, leaf_node_indices, leaf_count * sizeof(size_t));
+  qsort(leaves, leaf_count, sizeof(size_t), compare_size_t_desc);
+
+  size_t leaf_pos = 0, parent_head = 0, parent_tail = 0;
+  size_t count = 0;
+
+  for (;;) {
+    bool has_leaf = leaf_pos < leaf_count;
+    bool has_parent = parent_head < parent_tail;
+    if (!has_leaf && !has_parent)
+      break;
+
+    // Pop the largest known index, skipping duplicates
+    size_t index;
+    if (has_leaf &&
+        (!has_parent || leaves[leaf_pos] >= parents[parent_head % leaf_count]))
+      index = leaves[leaf_pos++];
+    else
+      index = parents[parent_head++ % leaf_count];
+
+    while (leaf_pos < leaf_count && leaves[leaf_pos] == index)
+      leaf_pos++;
+    while (parent_head < parent_tail &&
+           parents[parent_head % leaf_count] == index)
+      parent_head++;
+
+    if (index == 0)
+      break;
+
+    size_t sibling_index = (index % 2 == 0) ? index - 1 : index + 1;
+    bool sibling_known = false;
+    while (leaf_pos < leaf_count && leaves[leaf_pos] == sibling_index) {
+      sibling_known = true;
+      leaf_pos++;
+    }
+    if (parent_head < parent_tail &&
+        parents[parent_head % leaf_count] == sibling_index) {
+      sibling_known = true;
+      parent_head++;
+    }
+    if (!sibling_known)
+      out_indices[count++] = sibling_index;
+
+    parents[parent_tail++ % leaf_count] = (index - 1) / 2;
+  }
+
+  // Siblings were emitted in descending order
+  for (size_t i = 0; i < count / 2; ++i) {
+    size_t tmp = out_indices[i];
+    out_indices[i] = out_indices[count - 1 - i];
+    out_indices[count - 1 - i] = tmp;
+  }
+  *out_count = count;
+
+  free(leaves);
+  free(parents);
+  return true;
+}
+
+size_t MerkleTree__multiproof_capacity(const MerkleTree *self,
+                                       size_t leaf_count) {
+  size_t depth = 0;
+  for (size_t n = MerkleTree__node_count(self); n > 1; n /= 2)
+    depth++;
+  return leaf_count * (depth + 1);
+}
+
+bool MerkleTree__trace_multiproof(const MerkleTree *self,
+                                  const size_t *leaf_node_indices,
+                                  size_t leaf_count, HashMap nodes) {
+  size_t capacity = MerkleTree__multiproof_capacity(self, leaf_count);
+  size_t *indices =
+      (size_t *)malloc((capacity ? capacity : 1) * sizeof(size_t));
+  if (!indices)
+    return false;
+
+  size_t count = 0;
+  if (!MerkleTree__multiproof_indices(leaf_node_indices, leaf_count, indices,
+                                      &count)) {
+    free(indices);
+    return false;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    MerkleTree__insert_node_copy(self, nodes, indices[i]);
+  }
+
+  free(indices);
+  return true;
+}
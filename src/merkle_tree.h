@@ -5,6 +5,7 @@
 #include "config.h"
 #include "hashmap.h"
 #include "memory.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -15,6 +16,12 @@ typedef struct MerkleTree {
   Config config;
   /** The size of each node in bytes. */
   size_t node_size;
+  /**
+   * Distance in bytes between consecutive nodes in `nodes`. Equal to
+   * node_size for packed storage, or node_size rounded up to the requested
+   * alignment. Only the first node_size bytes of a slot are hashed.
+   */
+  size_t node_stride;
   /** Flat storage for all tree nodes (leaves and intermediate nodes). */
   uint8_t *nodes;
   size_t nodes_len;
@@ -32,6 +39,23 @@ size_t MerkleTree__calculate_node_size(const Config *config);
  */
 MerkleTree *MerkleTree__new(Config config);
 
+/**
+ * @brief Allocates a Merkle Tree whose node slots are padded to `alignment`.
+ *
+ * The logical node size (and therefore every hash and proof) is unchanged;
+ * only the in-memory layout differs. An alignment of 0 or 1 yields packed
+ * storage identical to MerkleTree__new. Otherwise alignment must be a power
+ * of two, and both the node buffer and every node start at a multiple of it.
+ *
+ * @return The new tree, or NULL on allocation failure or invalid alignment.
+ */
+MerkleTree *MerkleTree__new_with_stride(Config config, size_t alignment);
+
+/**
+ * @brief Returns the total number of nodes (leaves and intermediate nodes).
+ */
+size_t MerkleTree__node_count(const MerkleTree *self);
+
 /**
  * @brief Deallocates the MerkleTree structure.
  */
@@ -49,6 +73,14 @@ void MerkleTree__compute_leaf_hash(const ChallengeId *challenge_id,
                                    const Element *element, size_t node_size,
                                    uint8_t *output);
 
+/**
+ * @brief Computes the hash of an intermediate node from its two children.
+ */
+void MerkleTree__compute_parent_hash(const ChallengeId *challenge_id,
+                                     const uint8_t *left_node,
+                                     const uint8_t *right_node,
+                                     size_t node_size, uint8_t *output);
+
 /**
  * @brief Populates all leaf nodes in the Merkle Tree.
  */
@@ -56,6 +88,15 @@ void MerkleTree__compute_leaf_hashes(MerkleTree *self,
                                      const ChallengeId *challenge_id,
                                      const Memory *memory);
 
+/**
+ * @brief Populates the leaf nodes of memory elements [begin, end). Disjoint
+ * ranges may be computed concurrently.
+ */
+void MerkleTree__compute_leaf_range(MerkleTree *self,
+                                    const ChallengeId *challenge_id,
+                                    const Memory *memory, size_t begin,
+                                    size_t end);
+
 /**
  * @brief Computes all intermediate nodes up to the root node.
  */
@@ -75,6 +116,40 @@ void MerkleTree__children_of(size_t index, size_t *left_index,
 void MerkleTree__trace_node(const MerkleTree *self, size_t index,
                             HashMap nodes);
 
+/**
+ * @brief Computes the minimal multiproof for a set of leaf nodes.
+ *
+ * Selects the nodes a verifier needs to recompute the root from the given
+ * leaves but cannot derive itself: siblings on the authentication paths that
+ * are neither one of the leaves nor an ancestor of one. Leaves, shared
+ * ancestors and the root are never included. Duplicate leaves are allowed.
+ *
+ * @param leaf_node_indices Node indices of the opened leaves.
+ * @param leaf_count Number of entries in leaf_node_indices.
+ * @param out_indices Output buffer, filled in ascending index order. Must hold
+ * MerkleTree__multiproof_capacity(...) entries.
+ * @param out_count Number of indices written.
+ * @return false on allocation failure.
+ */
+bool MerkleTree__multiproof_indices(const size_t *leaf_node_indices,
+                                    size_t leaf_count, size_t *out_indices,
+                                    size_t *out_count);
+
+/**
+ * @brief Upper bound on the multiproof size for `leaf_count` leaves.
+ */
+size_t MerkleTree__multiproof_capacity(const MerkleTree *self,
+                                       size_t leaf_count);
+
+/**
+ * @brief Copies the minimal multiproof for the given leaves into `nodes`.
+ * @param nodes A hash map to store the resulting index -> node hash mapping.
+ * @return false on allocation failure.
+ */
+bool MerkleTree__trace_multiproof(const MerkleTree *self,
+                                  const size_t *leaf_node_indices,
+                                  size_t leaf_count, HashMap nodes);
+
 // --- Trait PartialMerkleTree (for verification) ---
 // With endianness removed, this wrapper is simplified
 typedef struct PartialMerkleTree_Wrapper {
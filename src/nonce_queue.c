@@ -0,0 +1,91 @@
+#include "nonce_queue.h"
+#include <stdlib.h>
+
+NonceQueue *NonceQueue__new(size_t capacity) {
+  if (capacity == 0)
+    return NULL;
+
+  size_t cell_count = 1;
+  while (cell_count < capacity)
+    cell_count <<= 1;
+
+  NonceQueue *self = (NonceQueue *)malloc(sizeof(NonceQueue));
+  if (!self)
+    return NULL;
+  self->cells = (NonceQueueCell *)malloc(cell_count * sizeof(NonceQueueCell));
+  if (!self->cells) {
+    free(self);
+    return NULL;
+  }
+
+  self->mask = cell_count - 1;
+  for (size_t i = 0; i < cell_count; ++i) {
+    atomic_init(&self->cells[i].sequence, i);
+  }
+  atomic_init(&self->push_position, 0);
+  atomic_init(&self->pop_position, 0);
+  return self;
+}
+
+bool NonceQueue__push(NonceQueue *self, uint64_t value) {
+  size_t position =
+      atomic_load_explicit(&self->push_position, memory_order_relaxed);
+  for (;;) {
+    NonceQueueCell *cell = &self->cells[position & self->mask];
+    size_t sequence =
+        atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t lag = (intptr_t)sequence - (intptr_t)position;
+
+    if (lag == 0) {
+      // The cell is free for this position; claim it
+      if (atomic_compare_exchange_weak_explicit(
+              &self->push_position, &position, position + 1,
+              memory_order_relaxed, memory_order_relaxed)) {
+        cell->value = value;
+        atomic_store_explicit(&cell->sequence, position + 1,
+                              memory_order_release);
+        return true;
+      }
+    } else if (lag < 0) {
+      return false; // Still holds the value from one lap ago
+    } else {
+      position =
+          atomic_load_explicit(&self->push_position, memory_order_relaxed);
+    }
+  }
+}
+
+bool NonceQueue__pop(NonceQueue *self, uint64_t *value) {
+  size_t position =
+      atomic_load_explicit(&self->pop_position, memory_order_relaxed);
+  for (;;) {
+    NonceQueueCell *cell = &self->cells[position & self->mask];
+    size_t sequence =
+        atomic_load_explicit(&cell->sequence, memory_order_acquire);
+    intptr_t lag = (intptr_t)sequence - (intptr_t)(position + 1);
+
+    if (lag == 0) {
+      if (atomic_compare_exchange_weak_explicit(
+              &self->pop_position, &position, position + 1,
+              memory_order_relaxed, memory_order_relaxed)) {
+        *value = cell->value;
+        // Hand the cell to the producer of the next lap
+        atomic_store_explicit(&cell->sequence, position + self->mask + 1,
+                              memory_order_release);
+        return true;
+      }
+    } else if (lag < 0) {
+      return false; // Not written yet
+    } else {
+      position =
+          atomic_load_explicit(&self->pop_position, memory_order_relaxed);
+    }
+  }
+}
+
+void NonceQueue__drop(NonceQueue *self) {
+  if (!self)
+    return;
+  free(self->cells);
+  free(self);
+}
@@ -0,0 +1,56 @@
+#ifndef NONCE_QUEUE_H
+#define NONCE_QUEUE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One slot of a NonceQueue. `sequence` tells producers and consumers
+ * whose turn it is to use the slot.
+ */
+typedef struct NonceQueueCell {
+  _Atomic size_t sequence;
+  uint64_t value;
+} NonceQueueCell;
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue of 64-bit
+ * values.
+ *
+ * Each cell carries a sequence number, so a push or a pop is a single
+ * compare-exchange on the shared position followed by a release store to the
+ * cell; no thread ever waits for another one.
+ */
+typedef struct NonceQueue {
+  size_t mask; // Cell count - 1; the cell count is a power of two
+  NonceQueueCell *cells;
+  _Atomic size_t push_position;
+  _Atomic size_t pop_position;
+} NonceQueue;
+
+/**
+ * @brief Allocates a queue holding at least `capacity` values.
+ * @return The queue, or NULL on allocation failure or capacity 0.
+ */
+NonceQueue *NonceQueue__new(size_t capacity);
+
+/**
+ * @brief Appends `value`.
+ * @return false if the queue is full.
+ */
+bool NonceQueue__push(NonceQueue *self, uint64_t value);
+
+/**
+ * @brief Removes the oldest value into `*value`.
+ * @return false if the queue is empty.
+ */
+bool NonceQueue__pop(NonceQueue *self, uint64_t *value);
+
+/**
+ * @brief Frees the queue. Safe to call with NULL.
+ */
+void NonceQueue__drop(NonceQueue *self);
+
+#endif // NONCE_QUEUE_H
@@ -0,0 +1,72 @@
+#include "pipeline.h"
+#include <stdlib.h>
+
+static void *ItsukuPipeline__build_main(void *arg) {
+  ItsukuPipeline *self = (ItsukuPipeline *)arg;
+  // A failed build leaves the slot unprepared; solve then builds in place
+  ItsukuSolver__prepare(self->build_slot, self->pending,
+                        self->pending_difficulty_bits);
+  return NULL;
+}
+
+void ItsukuPipeline__wait_build(ItsukuPipeline *self) {
+  if (!self->building)
+    return;
+  pthread_join(self->builder, NULL);
+  self->building = false;
+  ChallengeId__drop(self->pending);
+  self->pending = NULL;
+}
+
+ItsukuPipeline *ItsukuPipeline__new(Config config, const SearchOptions *options,
+                                    size_t build_threads) {
+  ItsukuPipeline *self = (ItsukuPipeline *)calloc(1, sizeof(ItsukuPipeline));
+  if (!self)
+    return NULL;
+
+  SearchOptions build_options =
+      options ? *options : SearchOptions__default();
+  build_options.thread_count = build_threads;
+  self->search_slot = ItsukuSolver__new(config, options);
+  self->build_slot = ItsukuSolver__new(config, &build_options);
+  if (!self->search_slot || !self->build_slot) {
+    ItsukuPipeline__drop(self);
+    return NULL;
+  }
+  return self;
+}
+
+SearchResult ItsukuPipeline__solve(ItsukuPipeline *self,
+                                   const ChallengeId *challenge_id,
+                                   size_t difficulty_bits,
+                                   const ChallengeId *next,
+                                   size_t next_difficulty_bits) {
+  ItsukuPipeline__wait_build(self);
+  if (ItsukuSolver__is_prepared(self->build_slot, challenge_id,
+                                difficulty_bits))
+    ItsukuSolver__swap_prepared(self->search_slot, self->build_slot);
+
+  if (next) {
+    self->pending = ChallengeId__new(next->bytes, next->bytes_len);
+    self->pending_difficulty_bits = next_difficulty_bits;
+    self->building =
+        self->pending && pthread_create(&self->builder, NULL,
+                                        ItsukuPipeline__build_main, self) == 0;
+    if (!self->building) {
+      ChallengeId__drop(self->pending);
+      self->pending = NULL;
+    }
+  }
+
+  return ItsukuSolver__solve(self->search_slot, challenge_id,
+                             difficulty_bits);
+}
+
+void ItsukuPipeline__drop(ItsukuPipeline *self) {
+  if (!self)
+    return;
+  ItsukuPipeline__wait_build(self);
+  ItsukuSolver__drop(self->search_slot);
+  ItsukuSolver__drop(self->build_slot);
+  free(self);
+}
@@ -0,0 +1,65 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "solver.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Double-buffered prover for challenges that arrive back to back.
+ *
+ * Two solver slots share one Config. While the search slot works on
+ * challenge N with the search threads, the build slot builds memory and
+ * tree for challenge N + 1 on its own, smaller pool. When N is solved or
+ * expires, the slots exchange their prepared state, so the search of N + 1
+ * starts without a build.
+ */
+typedef struct ItsukuPipeline {
+  ItsukuSolver *search_slot;
+  ItsukuSolver *build_slot;
+
+  // Background build of the next challenge into build_slot
+  pthread_t builder;
+  bool building;
+  /** Owned copy of the challenge being built. */
+  ChallengeId *pending;
+  size_t pending_difficulty_bits;
+} ItsukuPipeline;
+
+/**
+ * @brief Allocates both slots. options->thread_count sizes the search pool
+ * and `build_threads` the build pool (0 selects one per online CPU); the
+ * other options apply to every search.
+ * @return The pipeline, or NULL on allocation failure.
+ */
+ItsukuPipeline *ItsukuPipeline__new(Config config, const SearchOptions *options,
+                                    size_t build_threads);
+
+/**
+ * @brief Solves `challenge_id` and, meanwhile, builds `next` (if not NULL)
+ * at `next_difficulty_bits` in the background.
+ *
+ * If the previous call was told about this challenge, its prepared memory
+ * and tree are swapped in, waiting for the build to finish if necessary;
+ * otherwise the challenge is built in place first. The proof borrows
+ * `challenge_id`, as with ItsukuSolver__solve.
+ */
+SearchResult ItsukuPipeline__solve(ItsukuPipeline *self,
+                                   const ChallengeId *challenge_id,
+                                   size_t difficulty_bits,
+                                   const ChallengeId *next,
+                                   size_t next_difficulty_bits);
+
+/**
+ * @brief Waits until the background build, if any, is finished.
+ */
+void ItsukuPipeline__wait_build(ItsukuPipeline *self);
+
+/**
+ * @brief Waits for a background build and frees both slots. Safe to call
+ * with NULL.
+ */
+void ItsukuPipeline__drop(ItsukuPipeline *self);
+
+#endif // PIPELINE_H
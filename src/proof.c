@@ -1,7 +1,7 @@
 #include "proof.h"
+#include "blake3_lanes.h"
 #include "memory.h"
 #include <blake3.h>
-#include <limits.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,31 +10,20 @@
 #define BITS_PER_BYTE 8
 
 /**
- * @brief Retrieves a copy of an Element from full memory.
- *
- * Used by Proof__search to simulate MemoryType::get_element.
- */
-static Element Memory__get_element_copy_for_search(void *data, size_t index) {
-  const Memory *mem = (const Memory *)data;
-  const Element *elem_ptr = Memory__get((Memory *)mem, index);
-  if (elem_ptr) {
-    return *elem_ptr;
-  }
-  return Element__zero();
-}
-
-/**
- * @brief Retrieves a copy of an Element from a partial memory HashMap.
- *
- * Used by Proof__verify to safely reconstruct Elements without segfaults.
+ * @brief Binary search in a strictly ascending index array.
+ * @return Position of `key`, or `count` if it is absent.
  */
-static Element HashMap__get_element_copy_for_verify(void *data, size_t index) {
-  HashMap map = (HashMap)data;
-  Element *element_ptr = (Element *)HashMap__get(map, index);
-  if (element_ptr) {
-    return *element_ptr;
+static size_t find_sorted_index(const size_t *indices, size_t count,
+                                size_t key) {
+  size_t low = 0, high = count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (indices[mid] < key)
+      low = mid + 1;
+    else
+      high = mid;
   }
-  return Element__zero();
+  return (low < count && indices[low] == key) ? low : count;
 }
 
 /**
@@ -142,6 +131,284 @@ void Proof__calculate_omega_no_alloc(
   blake3_hasher_finalize(&hasher, omega_out, OMEGA_HASH_SIZE);
 }
 
+/**
+ * @brief Element of the Omega chain as it enters a hash: XORed with the
+ * challenge id and serialized little-endian.
+ */
+static void omega_element_bytes(Element element,
+                                const ChallengeId *challenge_id,
+                                uint8_t out[ELEMENT_SIZE]) {
+  Element__bitxor_assign__bytes(&element, challenge_id->bytes,
+                                challenge_id->bytes_len);
+  Element__to_le_bytes(&element, out);
+}
+
+/**
+ * @brief Y0 = HS(nonce || root_hash || challenge_id) for one group of up to
+ * BLAKE3_LANE_COUNT nonces.
+ */
+static void omega_seed_group(uint8_t *const y0[], const uint64_t nonces[],
+                             size_t lane_count,
+                             const ChallengeId *challenge_id,
+                             const uint8_t root_hash[OMEGA_HASH_SIZE]) {
+  size_t seed_len = 8 + OMEGA_HASH_SIZE + challenge_id->bytes_len;
+  uint8_t outputs[BLAKE3_LANE_COUNT][OMEGA_HASH_SIZE];
+
+  if (seed_len <= BLAKE3_LANE_MAX_INPUT) {
+    uint8_t seeds[BLAKE3_LANE_COUNT][BLAKE3_LANE_MAX_INPUT];
+    const uint8_t *inputs[BLAKE3_LANE_COUNT];
+    for (size_t l = 0; l < lane_count; ++l) {
+      u64_to_le_bytes(nonces[l], seeds[l]);
+      memcpy(&seeds[l][8], root_hash, OMEGA_HASH_SIZE);
+      memcpy(&seeds[l][8 + OMEGA_HASH_SIZE], challenge_id->bytes,
+             challenge_id->bytes_len);
+      inputs[l] = seeds[l];
+    }
+    Blake3Lanes__hash(inputs, seed_len, lane_count, outputs);
+  } else {
+    for (size_t l = 0; l < lane_count; ++l) {
+      uint8_t nonce_bytes[8];
+      u64_to_le_bytes(nonces[l], nonce_bytes);
+      blake3_hasher hasher;
+      blake3_hasher_init(&hasher);
+      blake3_hasher_update(&hasher, nonce_bytes, 8);
+      blake3_hasher_update(&hasher, root_hash, OMEGA_HASH_SIZE);
+      blake3_hasher_update(&hasher, challenge_id->bytes,
+                           challenge_id->bytes_len);
+      blake3_hasher_finalize(&hasher, outputs[l], OMEGA_HASH_SIZE);
+    }
+  }
+
+  for (size_t l = 0; l < lane_count; ++l) {
+    memcpy(y0[l], outputs[l], OMEGA_HASH_SIZE);
+  }
+}
+
+/**
+ * @brief Omega = HS(path[L] || ... || path[1] || element(Y0)) for one group,
+ * each message being one contiguous run of `len` bytes.
+ */
+static void omega_final_group(uint8_t omega_out[][OMEGA_HASH_SIZE],
+                              const uint8_t *const inputs[],
+                              size_t lane_count, size_t len) {
+  if (len <= BLAKE3_LANE_MAX_INPUT) {
+    Blake3Lanes__hash(inputs, len, lane_count, omega_out);
+    return;
+  }
+  for (size_t l = 0; l < lane_count; ++l) {
+    blake3_hasher hasher;
+    blake3_hasher_init(&hasher);
+    blake3_hasher_update(&hasher, inputs[l], len);
+    blake3_hasher_finalize(&hasher, omega_out[l], OMEGA_HASH_SIZE);
+  }
+}
+
+/**
+ * @brief Element source of an Omega walk: either a full Memory read through
+ * direct pointers, or any PartialMemory_Wrapper.
+ */
+typedef struct OmegaMemory {
+  Element *const *chunks; // NULL for the wrapper
+  size_t chunk_size;
+  size_t chunk_shift; // log2(chunk_size) when it is a power of two, else 0
+  PartialMemory_Wrapper wrapper;
+} OmegaMemory;
+
+static OmegaMemory OmegaMemory__full(const Memory *memory) {
+  OmegaMemory self = {.chunks = memory->chunks,
+                      .chunk_size = memory->config.chunk_size};
+  size_t size = self.chunk_size;
+  if (size > 1 && (size & (size - 1)) == 0) {
+    while ((size_t)1 << self.chunk_shift != size)
+      self.chunk_shift++;
+  }
+  return self;
+}
+
+/**
+ * @brief Address of a full-memory element; `index` is already reduced
+ * modulo the memory size, so no bounds check is needed.
+ */
+static inline const Element *OmegaMemory__element(const OmegaMemory *self,
+                                                  size_t index) {
+  if (self->chunk_shift)
+    return &self->chunks[index >> self->chunk_shift]
+                        [index & (self->chunk_size - 1)];
+  return &self->chunks[index / self->chunk_size][index % self->chunk_size];
+}
+
+static inline void OmegaMemory__prefetch(const OmegaMemory *self,
+                                         size_t index) {
+  if (self->chunks) {
+#if defined(__GNUC__)
+    __builtin_prefetch(OmegaMemory__element(self, index));
+#endif
+  } else if (self->wrapper.prefetch_element) {
+    self->wrapper.prefetch_element(self->wrapper.data, index);
+  }
+}
+
+/**
+ * @brief Writes element `index` XORed with the challenge id as LE bytes.
+ * @param challenge_lanes Challenge id as LE words, zero past its last full
+ * word (the words Element__bitxor_assign__bytes would apply).
+ */
+static inline void OmegaMemory__load(const OmegaMemory *self, size_t index,
+                                     const uint64_t challenge_lanes[LANES],
+                                     uint8_t out[ELEMENT_SIZE]) {
+  Element copy;
+  const Element *element;
+  if (self->chunks) {
+    element = OmegaMemory__element(self, index);
+  } else {
+    copy = self->wrapper.get_element(self->wrapper.data, index);
+    element = &copy;
+  }
+  for (size_t i = 0; i < LANES; ++i) {
+    u64_to_le_bytes(element->data[i] ^ challenge_lanes[i], &out[i * 8]);
+  }
+}
+
+/**
+ * @brief Shared body of the interleaved Omega walk; see
+ * Proof__calculate_omega_interleaved.
+ */
+static void omega_walk(uint8_t omega_out[][OMEGA_HASH_SIZE],
+                       const uint64_t nonces[], size_t nonce_count,
+                       uint8_t path_scratch[][OMEGA_HASH_SIZE],
+                       const Config *config, const ChallengeId *challenge_id,
+                       const OmegaMemory *memory,
+                       const uint8_t root_hash[OMEGA_HASH_SIZE],
+                       size_t memory_size) {
+  if (nonce_count == 0 || nonce_count > OMEGA_MAX_IN_FLIGHT)
+    return;
+
+  size_t L = config->search_length;
+  size_t group_count =
+      (nonce_count + BLAKE3_LANE_COUNT - 1) / BLAKE3_LANE_COUNT;
+
+  Element challenge_element = Element__zero();
+  Element__bitxor_assign__bytes(&challenge_element, challenge_id->bytes,
+                                challenge_id->bytes_len);
+  const uint64_t *challenge_lanes = challenge_element.data;
+
+  // Each nonce owns L + 1 slots laid out in back-sweep order: slot L - k
+  // holds path[k] for k >= 1, so the final Omega input is one contiguous
+  // run. Slot L holds Y0 until the end, when it becomes element(Y0).
+  uint8_t (*path[OMEGA_MAX_IN_FLIGHT])[OMEGA_HASH_SIZE];
+  uint8_t *slots[OMEGA_MAX_IN_FLIGHT];
+  size_t leaf[OMEGA_MAX_IN_FLIGHT];
+  for (size_t n = 0; n < nonce_count; ++n) {
+    path[n] = &path_scratch[n * (L + 1)];
+    slots[n] = path[n][L];
+  }
+
+  for (size_t g = 0; g < group_count; ++g) {
+    size_t first = g * BLAKE3_LANE_COUNT;
+    size_t lanes = nonce_count - first < BLAKE3_LANE_COUNT
+                       ? nonce_count - first
+                       : BLAKE3_LANE_COUNT;
+    omega_seed_group(&slots[first], &nonces[first], lanes, challenge_id,
+                     root_hash);
+  }
+
+  // The leaf of the next step is known as soon as the previous hash is, so
+  // it is prefetched right away and the other groups are hashed while the
+  // load is in flight
+  for (size_t n = 0; n < nonce_count; ++n) {
+    leaf[n] = (size_t)(u64_from_hash_le(slots[n]) % memory_size);
+    OmegaMemory__prefetch(memory, leaf[n]);
+  }
+
+  uint8_t steps[BLAKE3_LANE_COUNT][OMEGA_HASH_SIZE + ELEMENT_SIZE];
+  uint8_t outputs[BLAKE3_LANE_COUNT][OMEGA_HASH_SIZE];
+  const uint8_t *inputs[BLAKE3_LANE_COUNT];
+  for (size_t l = 0; l < BLAKE3_LANE_COUNT; ++l) {
+    inputs[l] = steps[l];
+  }
+
+  for (size_t j = 0; j < L; ++j) {
+    for (size_t g = 0; g < group_count; ++g) {
+      size_t first = g * BLAKE3_LANE_COUNT;
+      size_t lanes = nonce_count - first < BLAKE3_LANE_COUNT
+                         ? nonce_count - first
+                         : BLAKE3_LANE_COUNT;
+
+      for (size_t l = 0; l < lanes; ++l) {
+        size_t n = first + l;
+        memcpy(steps[l], path[n][L - j], OMEGA_HASH_SIZE);
+        OmegaMemory__load(memory, leaf[n], challenge_lanes,
+                          &steps[l][OMEGA_HASH_SIZE]);
+      }
+      Blake3Lanes__hash(inputs, sizeof(steps[0]), lanes, outputs);
+
+      for (size_t l = 0; l < lanes; ++l) {
+        size_t n = first + l;
+        memcpy(path[n][L - (j + 1)], outputs[l], OMEGA_HASH_SIZE);
+        if (j + 1 == L)
+          continue;
+        leaf[n] = (size_t)(u64_from_hash_le(outputs[l]) % memory_size);
+        OmegaMemory__prefetch(memory, leaf[n]);
+      }
+    }
+  }
+
+  for (size_t n = 0; n < nonce_count; ++n) {
+    Element element_from_hash;
+    memcpy(element_from_hash.data, path[n][L], OMEGA_HASH_SIZE);
+    omega_element_bytes(element_from_hash, challenge_id, path[n][L]);
+  }
+  for (size_t g = 0; g < group_count; ++g) {
+    size_t first = g * BLAKE3_LANE_COUNT;
+    size_t lanes = nonce_count - first < BLAKE3_LANE_COUNT
+                       ? nonce_count - first
+                       : BLAKE3_LANE_COUNT;
+    const uint8_t *finals[BLAKE3_LANE_COUNT];
+    for (size_t l = 0; l < lanes; ++l) {
+      finals[l] = path[first + l][0];
+    }
+    omega_final_group(&omega_out[first], finals, lanes,
+                      (L + 1) * OMEGA_HASH_SIZE);
+  }
+}
+
+void Proof__calculate_omega_interleaved(
+    uint8_t omega_out[][OMEGA_HASH_SIZE], const uint64_t nonces[],
+    size_t nonce_count, uint8_t path_scratch[][OMEGA_HASH_SIZE],
+    const Config *config, const ChallengeId *challenge_id,
+    PartialMemory_Wrapper memory_wrapper,
+    const uint8_t root_hash[OMEGA_HASH_SIZE], size_t memory_size) {
+  OmegaMemory memory = {.wrapper = memory_wrapper};
+  omega_walk(omega_out, nonces, nonce_count, path_scratch, config,
+             challenge_id, &memory, root_hash, memory_size);
+}
+
+void Proof__calculate_omega_full(uint8_t omega_out[][OMEGA_HASH_SIZE],
+                                 const uint64_t nonces[], size_t nonce_count,
+                                 uint8_t path_scratch[][OMEGA_HASH_SIZE],
+                                 const Config *config,
+                                 const ChallengeId *challenge_id,
+                                 const Memory *memory,
+                                 const uint8_t root_hash[OMEGA_HASH_SIZE]) {
+  OmegaMemory full = OmegaMemory__full(memory);
+  omega_walk(omega_out, nonces, nonce_count, path_scratch, config,
+             challenge_id, &full, root_hash,
+             config->chunk_count * config->chunk_size);
+}
+
+void Proof__calculate_omega_lanes(
+    uint8_t omega_out[][OMEGA_HASH_SIZE], const uint64_t nonces[],
+    size_t lane_count, uint8_t path_scratch[][OMEGA_HASH_SIZE],
+    const Config *config, const ChallengeId *challenge_id,
+    PartialMemory_Wrapper memory_wrapper,
+    const uint8_t root_hash[OMEGA_HASH_SIZE], size_t memory_size) {
+  if (lane_count > BLAKE3_LANE_COUNT)
+    return;
+  Proof__calculate_omega_interleaved(omega_out, nonces, lane_count,
+                                     path_scratch, config, challenge_id,
+                                     memory_wrapper, root_hash, memory_size);
+}
+
 /**
  * @brief Allocates buffers and calculates Omega hash.
  *
@@ -195,94 +462,148 @@ void Proof__calculate_omega(uint8_t omega_out[OMEGA_HASH_SIZE],
   *path_hashes_out = (uint8_t **)path;
 }
 
+static int compare_size_t_asc(const void *a, const void *b) {
+  size_t lhs = *(const size_t *)a;
+  size_t rhs = *(const size_t *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
 /**
- * @brief Searches sequentially for a nonce that satisfies the PoW difficulty.
+ * @brief Builds the collective opening for a winning nonce.
  *
- * @param config Proof configuration
- * @param challenge_id Challenge identifier
- * @param memory Full memory
- * @param merkle_tree Merkle tree of memory elements
- * @return Dynamically allocated Proof if found, otherwise NULL
+ * @param selected_leaves The L leaf indices visited by the Omega path
+ * (duplicates allowed).
+ * @return Dynamically allocated Proof, or NULL on allocation failure.
  */
-Proof *Proof__search(Config config, const ChallengeId *challenge_id,
-                     const Memory *memory, const MerkleTree *merkle_tree) {
-  const uint8_t *root_hash_ptr = MerkleTree__get_node(merkle_tree, 0);
-  if (!root_hash_ptr)
+static Proof *Proof__assemble(const Config *config,
+                              const ChallengeId *challenge_id,
+                              const Memory *memory,
+                              const MerkleTree *merkle_tree, uint64_t nonce,
+                              const size_t *selected_leaves) {
+  size_t L = config->search_length;
+  size_t memory_size = config->chunk_count * config->chunk_size;
+  size_t node_size = merkle_tree->node_size;
+
+  Proof *proof = (Proof *)calloc(1, sizeof(Proof));
+  if (!proof)
     return NULL;
 
-  uint8_t root_hash[OMEGA_HASH_SIZE];
-  memcpy(root_hash, root_hash_ptr, merkle_tree->node_size);
-  if (merkle_tree->node_size < OMEGA_HASH_SIZE) {
-    memset(root_hash + merkle_tree->node_size, 0,
-           OMEGA_HASH_SIZE - merkle_tree->node_size);
+  proof->config = *config;
+  proof->challenge_id = *challenge_id;
+  proof->nonce = nonce;
+
+  proof->leaf_indices = (size_t *)malloc((L ? L : 1) * sizeof(size_t));
+  if (!proof->leaf_indices)
+    goto fail;
+  memcpy(proof->leaf_indices, selected_leaves, L * sizeof(size_t));
+  qsort(proof->leaf_indices, L, sizeof(size_t), compare_size_t_asc);
+
+  size_t leaf_count = 0;
+  for (size_t i = 0; i < L; ++i) {
+    if (leaf_count == 0 ||
+        proof->leaf_indices[leaf_count - 1] != proof->leaf_indices[i])
+      proof->leaf_indices[leaf_count++] = proof->leaf_indices[i];
   }
+  proof->leaf_count = leaf_count;
 
-  size_t memory_size = config.chunk_count * config.chunk_size;
-  size_t L = config.search_length;
+  size_t slots = config->antecedent_count;
+  size_t slot_total = leaf_count * slots;
+  proof->leaf_antecedents =
+      (Element *)calloc(slot_total ? slot_total : 1, sizeof(Element));
+  if (!proof->leaf_antecedents)
+    goto fail;
 
-  size_t *selected_leaves = (size_t *)malloc(L * sizeof(size_t));
-  uint8_t (*path_hashes)[OMEGA_HASH_SIZE] =
-      (uint8_t (*)[OMEGA_HASH_SIZE])malloc((L + 1) * OMEGA_HASH_SIZE);
-  if (!selected_leaves || !path_hashes) {
-    if (selected_leaves)
-      free(selected_leaves);
-    if (path_hashes)
-      free(path_hashes);
-    return NULL;
+  for (size_t i = 0; i < leaf_count; ++i) {
+    Memory__copy_antecedents(memory, proof->leaf_indices[i],
+                             &proof->leaf_antecedents[i * slots]);
   }
 
-  PartialMemory_Wrapper memory_wrapper = {
-      .data = (void *)memory,
-      .get_element = Memory__get_element_copy_for_search};
+  size_t capacity = MerkleTree__multiproof_capacity(merkle_tree, leaf_count);
+  size_t *leaf_nodes = (size_t *)malloc((L ? L : 1) * sizeof(size_t));
+  proof->node_indices =
+      (size_t *)malloc((capacity ? capacity : 1) * sizeof(size_t));
+  if (!leaf_nodes || !proof->node_indices) {
+    free(leaf_nodes);
+    goto fail;
+  }
 
-  uint8_t omega[OMEGA_HASH_SIZE];
-  for (uint64_t nonce = 1; nonce < ULLONG_MAX; ++nonce) {
-    Proof__calculate_omega_no_alloc(omega, selected_leaves, path_hashes,
-                                    &config, challenge_id, memory_wrapper,
-                                    (PartialMerkleTree_Wrapper){0}, root_hash,
-                                    memory_size, nonce);
+  for (size_t i = 0; i < leaf_count; ++i) {
+    leaf_nodes[i] = memory_size - 1 + proof->leaf_indices[i];
+  }
+  bool traced = MerkleTree__multiproof_indices(
+      leaf_nodes, leaf_count, proof->node_indices, &proof->node_count);
+  free(leaf_nodes);
+  if (!traced)
+    goto fail;
 
-    if (Proof__leading_zeros(omega, OMEGA_HASH_SIZE) < config.difficulty_bits) {
-      continue;
-    }
+  proof->node_hashes = (uint8_t *)malloc(
+      (proof->node_count ? proof->node_count : 1) * node_size);
+  if (!proof->node_hashes)
+    goto fail;
 
-    Proof *proof = (Proof *)malloc(sizeof(Proof));
-    if (!proof) {
-      free(selected_leaves);
-      free(path_hashes);
-      return NULL;
-    }
+  for (size_t i = 0; i < proof->node_count; ++i) {
+    memcpy(&proof->node_hashes[i * node_size],
+           MerkleTree__get_node(merkle_tree, proof->node_indices[i]),
+           node_size);
+  }
 
-    proof->config = config;
-    proof->challenge_id = *challenge_id;
-    proof->nonce = nonce;
-    proof->leaf_antecedents = HashMap__new(free);
-    proof->tree_opening = HashMap__new(free);
-
-    for (size_t i = 0; i < L; ++i) {
-      size_t leaf_index = selected_leaves[i];
-      size_t node_index = memory_size - 1 + leaf_index;
-
-      Element *antecedents = NULL;
-      size_t antecedent_count =
-          Memory__trace_element(memory, leaf_index, &antecedents);
-      if (antecedent_count > 0) {
-        HashMap__insert(proof->leaf_antecedents, leaf_index, antecedents);
-      } else if (antecedents) {
-        free(antecedents);
-      }
+  const uint8_t *root_hash = MerkleTree__get_node(merkle_tree, 0);
+  proof->root_hash = (uint8_t *)malloc(node_size);
+  if (!root_hash || !proof->root_hash)
+    goto fail;
+  memcpy(proof->root_hash, root_hash, node_size);
 
-      MerkleTree__trace_node(merkle_tree, node_index, proof->tree_opening);
-    }
+  return proof;
+
+fail:
+  Proof__drop(proof);
+  return NULL;
+}
+
+bool Proof__padded_root(const MerkleTree *merkle_tree,
+                       uint8_t root_out[OMEGA_HASH_SIZE]) {
+  const uint8_t *root_hash_ptr = MerkleTree__get_node(merkle_tree, 0);
+  if (!root_hash_ptr)
+    return false;
+
+  memcpy(root_out, root_hash_ptr, merkle_tree->node_size);
+  if (merkle_tree->node_size < OMEGA_HASH_SIZE) {
+    memset(root_out + merkle_tree->node_size, 0,
+           OMEGA_HASH_SIZE - merkle_tree->node_size);
+  }
+  return true;
+}
+
+Proof *Proof__from_nonce(const Config *config, const ChallengeId *challenge_id,
+                         const Memory *memory, const MerkleTree *merkle_tree,
+                         uint64_t nonce) {
+  uint8_t root_hash[OMEGA_HASH_SIZE];
+  if (!Proof__padded_root(merkle_tree, root_hash))
+    return NULL;
+
+  size_t memory_size = config->chunk_count * config->chunk_size;
+  size_t L = config->search_length;
 
+  size_t *selected_leaves = (size_t *)malloc((L ? L : 1) * sizeof(size_t));
+  uint8_t (*path_hashes)[OMEGA_HASH_SIZE] =
+      (uint8_t (*)[OMEGA_HASH_SIZE])malloc((L + 1) * OMEGA_HASH_SIZE);
+  if (!selected_leaves || !path_hashes) {
     free(selected_leaves);
     free(path_hashes);
-    return proof;
+    return NULL;
   }
 
+  uint8_t omega[OMEGA_HASH_SIZE];
+  Proof__calculate_omega_no_alloc(omega, selected_leaves, path_hashes, config,
+                                  challenge_id, Memory__as_partial(memory),
+                                  (PartialMerkleTree_Wrapper){0}, root_hash,
+                                  memory_size, nonce);
+
+  Proof *proof = Proof__assemble(config, challenge_id, memory, merkle_tree,
+                                 nonce, selected_leaves);
   free(selected_leaves);
   free(path_hashes);
-  return NULL;
+  return proof;
 }
 
 /**
@@ -290,172 +611,523 @@ Proof *Proof__search(Config config, const ChallengeId *challenge_id,
  */
 void Proof__drop(Proof *self) {
   if (self) {
-    HashMap__drop(self->leaf_antecedents);
-    HashMap__drop(self->tree_opening);
+    free(self->leaf_indices);
+    free(self->leaf_antecedents);
+    free(self->node_indices);
+    free(self->node_hashes);
+    free(self->root_hash);
     free(self);
   }
 }
 
+size_t Proof__antecedent_count_for_leaf(const Config *config,
+                                        size_t leaf_index) {
+  size_t element_index_in_chunk = leaf_index % config->chunk_size;
+  return (element_index_in_chunk < config->antecedent_count)
+             ? 1
+             : config->antecedent_count;
+}
+
+const Element *Proof__get_antecedents(const Proof *self, size_t leaf_index,
+                                      size_t *count_out) {
+  size_t pos = find_sorted_index(self->leaf_indices, self->leaf_count,
+                                 leaf_index);
+  if (pos == self->leaf_count)
+    return NULL;
+
+  if (count_out)
+    *count_out = Proof__antecedent_count_for_leaf(&self->config, leaf_index);
+  return &self->leaf_antecedents[pos * self->config.antecedent_count];
+}
+
+const uint8_t *Proof__get_node(const Proof *self, size_t node_index) {
+  size_t pos = find_sorted_index(self->node_indices, self->node_count,
+                                 node_index);
+  if (pos == self->node_count)
+    return NULL;
+
+  size_t node_size = MerkleTree__calculate_node_size(&self->config);
+  return &self->node_hashes[pos * node_size];
+}
+
+HashMap Proof__leaf_antecedents_map(const Proof *self) {
+  HashMap map = HashMap__new(NULL);
+  if (!map)
+    return NULL;
+
+  for (size_t i = 0; i < self->leaf_count; ++i) {
+    HashMap__insert(
+        map, self->leaf_indices[i],
+        &self->leaf_antecedents[i * self->config.antecedent_count]);
+  }
+  return map;
+}
+
+HashMap Proof__tree_opening_map(const Proof *self) {
+  HashMap map = HashMap__new(NULL);
+  if (!map)
+    return NULL;
+
+  size_t node_size = MerkleTree__calculate_node_size(&self->config);
+  for (size_t i = 0; i < self->node_count; ++i) {
+    HashMap__insert(map, self->node_indices[i],
+                    &self->node_hashes[i * node_size]);
+  }
+  return map;
+}
+
 /**
- * @brief Verifies a Proof against its challenge and configuration.
- *
- * @param self Proof to verify
- * @return VerificationError__Ok if valid, otherwise an error code
+ * @brief Looks up an opened node hash with a known node size.
  */
-VerificationError Proof__verify(const Proof *self) {
+static const uint8_t *Proof__find_node(const Proof *self, size_t node_index,
+                                       size_t node_size) {
+  size_t pos = find_sorted_index(self->node_indices, self->node_count,
+                                 node_index);
+  return pos < self->node_count ? &self->node_hashes[pos * node_size] : NULL;
+}
+
+/**
+ * @brief Working memory of one verification, carved out of the caller's
+ * scratch buffer (see Proof__verify_scratch_size).
+ */
+typedef struct VerifyScratch {
+  Element *elements;                // Reconstructed opened leaves
+  size_t *leaf_nodes;               // Node index of each opened leaf
+  size_t *parent_nodes;             // Ring of nodes awaiting their parent
+  uint8_t (*path)[OMEGA_HASH_SIZE]; // Omega path hashes
+  uint8_t *leaf_hashes;             // node_size bytes per opened leaf
+  uint8_t *parent_hashes;           // node_size bytes per ring slot
+  uint8_t *parent_hash;             // The node being derived
+  bool *built;                      // Whether elements[i] is reconstructed
+} VerifyScratch;
+
+/**
+ * @brief Bytes of scratch needed for a search length of `L` and nodes of
+ * `node_size` bytes.
+ */
+static size_t VerifyScratch__size(size_t L, size_t node_size) {
+  size_t slots = L ? L : 1;
+  return slots * (sizeof(Element) + 2 * sizeof(size_t) + 2 * node_size +
+                  sizeof(bool)) +
+         (L + 1) * OMEGA_HASH_SIZE + node_size;
+}
+
+/**
+ * @brief Splits a buffer of VerifyScratch__size(L, node_size) bytes. Arrays
+ * of 8-byte words come first, so every one of them stays aligned.
+ */
+static void VerifyScratch__carve(VerifyScratch *self, void *scratch, size_t L,
+                                 size_t node_size) {
+  size_t slots = L ? L : 1;
+  uint8_t *cursor = (uint8_t *)scratch;
+  self->elements = (Element *)cursor;
+  cursor += slots * sizeof(Element);
+  self->leaf_nodes = (size_t *)cursor;
+  cursor += slots * sizeof(size_t);
+  self->parent_nodes = (size_t *)cursor;
+  cursor += slots * sizeof(size_t);
+  self->path = (uint8_t (*)[OMEGA_HASH_SIZE])cursor;
+  cursor += (L + 1) * OMEGA_HASH_SIZE;
+  self->leaf_hashes = cursor;
+  cursor += slots * node_size;
+  self->parent_hashes = cursor;
+  cursor += slots * node_size;
+  self->parent_hash = cursor;
+  cursor += node_size;
+  self->built = (bool *)cursor;
+}
+
+/**
+ * @brief Reconstructs the element of the opened leaf at position `pos` from
+ * its antecedents, once; later calls return the cached copy.
+ */
+static const Element *Proof__reconstruct_element(const Proof *self,
+                                                 VerifyScratch *scratch,
+                                                 size_t pos) {
+  if (scratch->built[pos])
+    return &scratch->elements[pos];
+
   const Config *config = &self->config;
-  const ChallengeId *challenge_id = &self->challenge_id;
-  size_t node_size = MerkleTree__calculate_node_size(config);
-  size_t memory_size = config->chunk_count * config->chunk_size;
-  VerificationError err = VerificationError__Ok;
-  HashMap merkle_nodes = NULL;
+  size_t leaf_index = self->leaf_indices[pos];
+  const Element *antecedents =
+      &self->leaf_antecedents[pos * config->antecedent_count];
+  size_t ante_count = Proof__antecedent_count_for_leaf(config, leaf_index);
+  if (ante_count == 1) {
+    scratch->elements[pos] = antecedents[0];
+  } else {
+    scratch->elements[pos] =
+        Memory__compress(antecedents, ante_count, (uint64_t)leaf_index,
+                         &self->challenge_id);
+  }
+  scratch->built[pos] = true;
+  return &scratch->elements[pos];
+}
 
-  HashMap partial_memory = HashMap__new(free);
-  if (!partial_memory)
-    return VerificationError__RequiredElementMissing;
+size_t Proof__verify_scratch_size(const Config *config) {
+  return VerifyScratch__size(config->search_length,
+                             MerkleTree__calculate_node_size(config));
+}
 
-  HashMapIterator ante_iter = HashMapIterator__new(self->leaf_antecedents);
-  size_t leaf_index;
-  void *antecedents_ptr;
-
-  while (HashMapIterator__next(&ante_iter, &leaf_index, &antecedents_ptr)) {
-    const Element *antecedents = (const Element *)antecedents_ptr;
-    size_t element_index_in_chunk = leaf_index % config->chunk_size;
-    size_t ante_count = (element_index_in_chunk < config->antecedent_count)
-                            ? 1
-                            : config->antecedent_count;
-
-    Element *reconstructed_element = (Element *)malloc(sizeof(Element));
-    if (!reconstructed_element) {
-      err = VerificationError__RequiredElementMissing;
-      goto cleanup;
-    }
+/**
+ * @brief Checks from indices alone that the multiproof holds every sibling
+ * the root recomputation will need.
+ *
+ * Walks the same descending merge of opened leaves and derived parents as
+ * Proof__recompute_root, but without hashing, so a proof with an incomplete
+ * opening is rejected before any BLAKE3 work.
+ */
+static VerificationError Proof__check_paths(const Proof *self,
+                                            VerifyScratch *scratch,
+                                            size_t leaf_count) {
+  const size_t *leaf_nodes = scratch->leaf_nodes;
+  size_t *parents = scratch->parent_nodes;
+  size_t known_left = leaf_count, parent_head = 0, parent_tail = 0;
 
-    if (ante_count == 1) {
-      *reconstructed_element = antecedents[0];
-    } else if (ante_count == config->antecedent_count) {
-      *reconstructed_element = Memory__compress(
-          antecedents, ante_count, (uint64_t)leaf_index, challenge_id);
-    } else {
-      free(reconstructed_element);
-      err = VerificationError__InvalidAntecedentCount;
-      goto cleanup;
-    }
+  for (;;) {
+    size_t index;
+    if (known_left > 0 &&
+        (parent_head == parent_tail ||
+         leaf_nodes[known_left - 1] > parents[parent_head % leaf_count]))
+      index = leaf_nodes[--known_left];
+    else
+      index = parents[parent_head++ % leaf_count];
+
+    if (index == 0)
+      return VerificationError__Ok;
+
+    size_t sibling_index = (index % 2 == 0) ? index - 1 : index + 1;
+    if (known_left > 0 && leaf_nodes[known_left - 1] == sibling_index)
+      --known_left;
+    else if (parent_head < parent_tail &&
+             parents[parent_head % leaf_count] == sibling_index)
+      ++parent_head;
+    else if (find_sorted_index(self->node_indices, self->node_count,
+                               sibling_index) == self->node_count)
+      return VerificationError__MissingChildNode;
+
+    parents[parent_tail++ % leaf_count] = (index - 1) / 2;
+  }
+}
+
+/**
+ * @brief Parent nodes whose hash is still to be computed. Up to
+ * BLAKE3_LANE_COUNT of them are hashed side by side; each message is a copy
+ * of left || right || challenge, so the children may be overwritten in the
+ * meantime.
+ */
+typedef struct ParentBatch {
+  size_t count;
+  size_t message_len;
+  uint8_t messages[BLAKE3_LANE_COUNT][BLAKE3_LANE_MAX_INPUT];
+  uint8_t *targets[BLAKE3_LANE_COUNT];      // Ring slots for the hashes
+  const uint8_t *opened[BLAKE3_LANE_COUNT]; // Opened copies to match, if any
+} ParentBatch;
 
-    HashMap__insert(partial_memory, leaf_index, reconstructed_element);
+/**
+ * @brief Hashes the pending parents into their ring slots and checks them
+ * against the opening.
+ */
+static VerificationError ParentBatch__flush(ParentBatch *self,
+                                            size_t node_size) {
+  uint8_t hashes[BLAKE3_LANE_COUNT][BLAKE3_LANE_OUTPUT];
+  if (self->count == 1) {
+    blake3_hasher hasher;
+    blake3_hasher_init(&hasher);
+    blake3_hasher_update(&hasher, self->messages[0], self->message_len);
+    blake3_hasher_finalize(&hasher, hashes[0], node_size);
+  } else if (self->count > 1) {
+    const uint8_t *inputs[BLAKE3_LANE_COUNT];
+    for (size_t l = 0; l < self->count; ++l) {
+      inputs[l] = self->messages[l];
+    }
+    // The 64-byte output starts with the node_size-byte one
+    Blake3Lanes__hash(inputs, self->message_len, self->count, hashes);
   }
 
-  merkle_nodes = HashMap__new(free);
-  if (!merkle_nodes) {
-    err = VerificationError__RequiredElementMissing;
-    goto cleanup;
+  size_t count = self->count;
+  self->count = 0;
+  for (size_t l = 0; l < count; ++l) {
+    memcpy(self->targets[l], hashes[l], node_size);
+    if (self->opened[l] && memcmp(self->opened[l], hashes[l], node_size) != 0)
+      return VerificationError__IntermediateHashMismatch;
   }
+  return VerificationError__Ok;
+}
+
+/**
+ * @brief Hashes the opened leaves up to the Merkle root.
+ *
+ * `scratch->leaf_hashes` must hold the recomputed leaf hashes of the nodes
+ * in `scratch->leaf_nodes` (strictly ascending). Nodes are consumed in
+ * descending index order, so two opened siblings are paired and every
+ * shared ancestor is hashed once. Missing siblings are taken from the
+ * proof's multiproof; a derived node that is also present in the opening
+ * must match it. Derived nodes wait for their sibling in a ring buffer that
+ * keeps each node's hash next to its index: no more than leaf_count nodes
+ * are ever pending, and nothing is looked up by index.
+ *
+ * Since all nodes of a level are larger than those of the level above, a
+ * whole level is derived before any of its nodes is needed again. Parent
+ * hashes are therefore deferred and computed BLAKE3_LANE_COUNT at a time,
+ * just before the first pending one is consumed.
+ *
+ * @param root_out Receives the recomputed root (node_size bytes).
+ */
+static VerificationError Proof__recompute_root(const Proof *self,
+                                               VerifyScratch *scratch,
+                                               size_t leaf_count,
+                                               size_t node_size,
+                                               uint8_t *root_out) {
+  if (leaf_count == 0)
+    return VerificationError__MissingMerkleRoot;
 
-  HashMapIterator mem_iter = HashMapIterator__new(partial_memory);
-  size_t current_leaf_index;
-  void *element_ptr;
+  const ChallengeId *challenge_id = &self->challenge_id;
+  ParentBatch batch = {.count = 0,
+                       .message_len = 2 * node_size + challenge_id->bytes_len};
+  // Oversized nodes or messages are hashed one by one
+  size_t batch_limit = node_size <= BLAKE3_LANE_OUTPUT &&
+                               batch.message_len <= BLAKE3_LANE_MAX_INPUT
+                           ? BLAKE3_LANE_COUNT
+                           : 0;
 
-  while (HashMapIterator__next(&mem_iter, &current_leaf_index, &element_ptr)) {
-    const Element *element = (const Element *)element_ptr;
-    size_t node_index = memory_size - 1 + current_leaf_index;
-    uint8_t *leaf_hash = (uint8_t *)malloc(node_size);
-    if (!leaf_hash) {
-      err = VerificationError__RequiredElementMissing;
-      goto cleanup;
+  const size_t *leaf_nodes = scratch->leaf_nodes;
+  size_t *parents = scratch->parent_nodes;
+  size_t known_left = leaf_count, parent_head = 0, parent_tail = 0;
+  VerificationError err = VerificationError__Ok;
+
+  for (;;) {
+    size_t index;
+    const uint8_t *node;
+    bool has_parent = parent_head < parent_tail;
+    if (known_left > 0 &&
+        (!has_parent ||
+         leaf_nodes[known_left - 1] > parents[parent_head % leaf_count])) {
+      --known_left;
+      index = leaf_nodes[known_left];
+      node = &scratch->leaf_hashes[known_left * node_size];
+    } else {
+      // Pending parents sit at the tail of the ring
+      if (batch.count > 0 && parent_tail - parent_head <= batch.count &&
+          (err = ParentBatch__flush(&batch, node_size)) !=
+              VerificationError__Ok)
+        return err;
+      size_t slot = parent_head++ % leaf_count;
+      index = parents[slot];
+      node = &scratch->parent_hashes[slot * node_size];
     }
 
-    MerkleTree__compute_leaf_hash(challenge_id, element, node_size, leaf_hash);
+    if (index == 0) {
+      memcpy(root_out, node, node_size);
+      return VerificationError__Ok;
+    }
 
-    const uint8_t *opened_hash =
-        (const uint8_t *)HashMap__get(self->tree_opening, node_index);
-    if (!opened_hash) {
-      free(leaf_hash);
-      err = VerificationError__MissingOpeningForLeaf;
-      goto cleanup;
+    size_t sibling_index = (index % 2 == 0) ? index - 1 : index + 1;
+    const uint8_t *sibling = NULL;
+    if (known_left > 0 && leaf_nodes[known_left - 1] == sibling_index) {
+      --known_left;
+      sibling = &scratch->leaf_hashes[known_left * node_size];
+    } else if (parent_head < parent_tail &&
+               parents[parent_head % leaf_count] == sibling_index) {
+      if (batch.count > 0 && parent_tail - parent_head <= batch.count &&
+          (err = ParentBatch__flush(&batch, node_size)) !=
+              VerificationError__Ok)
+        return err;
+      size_t slot = parent_head++ % leaf_count;
+      sibling = &scratch->parent_hashes[slot * node_size];
+    } else {
+      sibling = Proof__find_node(self, sibling_index, node_size);
     }
 
-    if (memcmp(opened_hash, leaf_hash, node_size) != 0) {
-      free(leaf_hash);
-      err = VerificationError__LeafHashMismatch;
-      goto cleanup;
+    if (!sibling)
+      return VerificationError__MissingChildNode;
+
+    const uint8_t *left = (index % 2 == 0) ? sibling : node;
+    const uint8_t *right = (index % 2 == 0) ? node : sibling;
+    size_t parent_index = (index - 1) / 2;
+    const uint8_t *opened_hash =
+        Proof__find_node(self, parent_index, node_size);
+    size_t slot = parent_tail++ % leaf_count;
+    parents[slot] = parent_index;
+    uint8_t *parent_hash = &scratch->parent_hashes[slot * node_size];
+
+    if (batch_limit == 0) {
+      // The ring slot may be the one `node` or `sibling` points to
+      MerkleTree__compute_parent_hash(challenge_id, left, right, node_size,
+                                      scratch->parent_hash);
+      if (opened_hash &&
+          memcmp(opened_hash, scratch->parent_hash, node_size) != 0)
+        return VerificationError__IntermediateHashMismatch;
+      memcpy(parent_hash, scratch->parent_hash, node_size);
+      continue;
     }
 
-    HashMap__insert(merkle_nodes, node_index, leaf_hash);
+    uint8_t *message = batch.messages[batch.count];
+    memcpy(message, left, node_size);
+    memcpy(&message[node_size], right, node_size);
+    memcpy(&message[2 * node_size], challenge_id->bytes,
+           challenge_id->bytes_len);
+    batch.targets[batch.count] = parent_hash;
+    batch.opened[batch.count] = opened_hash;
+    if (++batch.count == batch_limit &&
+        (err = ParentBatch__flush(&batch, node_size)) != VerificationError__Ok)
+      return err;
   }
+}
 
-  HashMapIterator opening_iter = HashMapIterator__new(self->tree_opening);
-  size_t node_idx;
-  void *opened_hash_ptr;
-  while (HashMapIterator__next(&opening_iter, &node_idx, &opened_hash_ptr)) {
-    if (!HashMap__get(merkle_nodes, node_idx)) {
-      uint8_t *copy = (uint8_t *)malloc(node_size);
-      if (!copy) {
-        err = VerificationError__RequiredElementMissing;
-        goto cleanup;
-      }
-      memcpy(copy, opened_hash_ptr, node_size);
-      HashMap__insert(merkle_nodes, node_idx, copy);
-    }
+/**
+ * @brief Walks the Omega path of the proof's nonce over the opened leaves
+ * and checks the difficulty.
+ *
+ * Same hashes as Proof__calculate_omega_no_alloc, but a leaf is
+ * reconstructed on its first visit and the walk stops at the first visited
+ * leaf the proof does not open.
+ */
+static VerificationError Proof__check_omega(const Proof *self,
+                                            VerifyScratch *scratch,
+                                            const uint8_t *root_hash) {
+  const Config *config = &self->config;
+  const ChallengeId *challenge_id = &self->challenge_id;
+  size_t L = config->search_length;
+  size_t memory_size = config->chunk_count * config->chunk_size;
+  uint8_t (*path)[OMEGA_HASH_SIZE] = scratch->path;
+  uint8_t element_bytes[ELEMENT_SIZE];
+
+  blake3_hasher hasher;
+  blake3_hasher_init(&hasher);
+  uint8_t nonce_bytes[8];
+  u64_to_le_bytes(self->nonce, nonce_bytes);
+  blake3_hasher_update(&hasher, nonce_bytes, 8);
+  blake3_hasher_update(&hasher, root_hash, OMEGA_HASH_SIZE);
+  blake3_hasher_update(&hasher, challenge_id->bytes, challenge_id->bytes_len);
+  blake3_hasher_finalize(&hasher, path[0], OMEGA_HASH_SIZE);
+
+  for (size_t j = 0; j < L; ++j) {
+    size_t index = (size_t)(u64_from_hash_le(path[j]) % memory_size);
+    size_t pos = find_sorted_index(self->leaf_indices, self->leaf_count, index);
+    if (pos == self->leaf_count)
+      return VerificationError__UnprovenLeafInPath;
+
+    Element element = *Proof__reconstruct_element(self, scratch, pos);
+    Element__bitxor_assign__bytes(&element, challenge_id->bytes,
+                                  challenge_id->bytes_len);
+    Element__to_le_bytes(&element, element_bytes);
+
+    blake3_hasher_reset(&hasher);
+    blake3_hasher_update(&hasher, path[j], OMEGA_HASH_SIZE);
+    blake3_hasher_update(&hasher, element_bytes, ELEMENT_SIZE);
+    blake3_hasher_finalize(&hasher, path[j + 1], OMEGA_HASH_SIZE);
   }
 
-  const uint8_t *root_hash_ptr =
-      (const uint8_t *)HashMap__get(self->tree_opening, 0);
-  if (!root_hash_ptr) {
-    err = VerificationError__MissingMerkleRoot;
-    goto cleanup;
+  blake3_hasher_reset(&hasher);
+  for (size_t k = L; k >= 1; --k) {
+    blake3_hasher_update(&hasher, path[k], OMEGA_HASH_SIZE);
   }
+  Element seed;
+  memcpy(seed.data, path[0], OMEGA_HASH_SIZE);
+  Element__bitxor_assign__bytes(&seed, challenge_id->bytes,
+                                challenge_id->bytes_len);
+  Element__to_le_bytes(&seed, element_bytes);
+  blake3_hasher_update(&hasher, element_bytes, ELEMENT_SIZE);
 
-  uint8_t root_hash[OMEGA_HASH_SIZE];
-  memcpy(root_hash, root_hash_ptr, node_size);
-  if (node_size < OMEGA_HASH_SIZE) {
-    memset(root_hash + node_size, 0, OMEGA_HASH_SIZE - node_size);
+  uint8_t omega[OMEGA_HASH_SIZE];
+  blake3_hasher_finalize(&hasher, omega, OMEGA_HASH_SIZE);
+  if (Proof__leading_zeros(omega, OMEGA_HASH_SIZE) < config->difficulty_bits)
+    return VerificationError__DifficultyNotMet;
+  return VerificationError__Ok;
+}
+
+/**
+ * @brief Checks that an index array is strictly ascending and below `limit`.
+ */
+static bool is_sorted_index_array(const size_t *indices, size_t count,
+                                  size_t limit) {
+  for (size_t i = 0; i < count; ++i) {
+    if (indices[i] >= limit || (i > 0 && indices[i - 1] >= indices[i]))
+      return false;
   }
+  return true;
+}
+
+/**
+ * @brief Verifies a Proof against its challenge and configuration.
+ *
+ * @param self Proof to verify
+ * @return VerificationError__Ok if valid, otherwise an error code
+ */
+VerificationError Proof__verify(const Proof *self) {
+  size_t scratch_size = Proof__verify_scratch_size(&self->config);
+  void *scratch = malloc(scratch_size);
+  if (!scratch)
+    return VerificationError__RequiredElementMissing;
 
-  PartialMemory_Wrapper verify_memory_wrapper = {
-      .data = partial_memory,
-      .get_element = HashMap__get_element_copy_for_verify};
+  VerificationError err = Proof__verify_in(self, scratch, scratch_size);
+  free(scratch);
+  return err;
+}
 
-  PartialMerkleTree_Wrapper merkle_tree_wrapper = {
-      .data = merkle_nodes,
-      .get_node = NULL // Not used in calculate_omega
-  };
+VerificationError Proof__verify_in(const Proof *self, void *scratch,
+                                   size_t scratch_size) {
+  const Config *config = &self->config;
+  const ChallengeId *challenge_id = &self->challenge_id;
+  size_t node_size = MerkleTree__calculate_node_size(config);
+  size_t memory_size = config->chunk_count * config->chunk_size;
+  size_t leaf_count = self->leaf_count;
 
-  uint8_t omega[OMEGA_HASH_SIZE];
-  size_t *selected_leaves = NULL;
-  size_t selected_leaves_len = 0;
-  uint8_t **path_hashes = NULL;
-  size_t path_len = 0;
-
-  Proof__calculate_omega(omega, &selected_leaves_len, &selected_leaves,
-                         &path_len, &path_hashes, config, challenge_id,
-                         verify_memory_wrapper, merkle_tree_wrapper, root_hash,
-                         memory_size, self->nonce);
-
-  bool unproven_leaf = false;
-  for (size_t i = 0; i < selected_leaves_len; ++i) {
-    if (HashMap__get(self->leaf_antecedents, selected_leaves[i]) == NULL) {
-      unproven_leaf = true;
-      break;
-    }
-  }
+  // Stage 1, no hashing: counts, index ranges and path completeness. The
+  // Omega path visits at most search_length distinct leaves.
+  if (!self->root_hash)
+    return VerificationError__MissingMerkleRoot;
+  if (leaf_count > config->search_length ||
+      !is_sorted_index_array(self->leaf_indices, leaf_count, memory_size) ||
+      !is_sorted_index_array(self->node_indices, self->node_count,
+                             2 * memory_size - 1))
+    return VerificationError__MalformedProofPath;
+  if (leaf_count == 0)
+    return VerificationError__MissingMerkleRoot;
+  if (scratch_size < VerifyScratch__size(config->search_length, node_size))
+    return VerificationError__RequiredElementMissing;
 
-  if (unproven_leaf) {
-    err = VerificationError__UnprovenLeafInPath;
-    goto free_and_cleanup_omega;
+  VerifyScratch buffers;
+  VerifyScratch__carve(&buffers, scratch, config->search_length, node_size);
+  for (size_t i = 0; i < leaf_count; ++i) {
+    buffers.leaf_nodes[i] = memory_size - 1 + self->leaf_indices[i];
   }
+  VerificationError err = Proof__check_paths(self, &buffers, leaf_count);
+  if (err != VerificationError__Ok)
+    return err;
 
-  if (Proof__leading_zeros(omega, OMEGA_HASH_SIZE) < config->difficulty_bits) {
-    err = VerificationError__DifficultyNotMet;
-    goto free_and_cleanup_omega;
-  }
+  // Stage 2: the Omega walk and difficulty against the claimed root. Only
+  // the leaves it visits are reconstructed, and it stops at the first leaf
+  // not opened.
+  memset(buffers.built, 0, leaf_count * sizeof(bool));
+  size_t root_size = node_size < OMEGA_HASH_SIZE ? node_size : OMEGA_HASH_SIZE;
+  uint8_t root_hash[OMEGA_HASH_SIZE] = {0};
+  memcpy(root_hash, self->root_hash, root_size);
+  err = Proof__check_omega(self, &buffers, root_hash);
+  if (err != VerificationError__Ok)
+    return err;
 
-free_and_cleanup_omega:
-  free(selected_leaves);
-  free(path_hashes);
+  // Stage 3: hash the leaves, reconstructing any the walk never reached,
+  // and the paths; they must reproduce the root
+  for (size_t i = 0; i < leaf_count; ++i) {
+    uint8_t *leaf_hash = &buffers.leaf_hashes[i * node_size];
+    MerkleTree__compute_leaf_hash(challenge_id,
+                                  Proof__reconstruct_element(self, &buffers, i),
+                                  node_size, leaf_hash);
 
-cleanup:
-  HashMap__drop(merkle_nodes);
-  HashMap__drop(partial_memory);
+    // Leaves are derived, not opened; older full openings still carry them
+    const uint8_t *opened_hash =
+        Proof__find_node(self, buffers.leaf_nodes[i], node_size);
+    if (opened_hash && memcmp(opened_hash, leaf_hash, node_size) != 0)
+      return VerificationError__LeafHashMismatch;
+  }
 
-  return err;
+  // The derivation buffer is free again once the root is reached
+  err = Proof__recompute_root(self, &buffers, leaf_count, node_size,
+                              buffers.parent_hash);
+  if (err != VerificationError__Ok)
+    return err;
+  if (memcmp(buffers.parent_hash, self->root_hash, node_size) != 0)
+    return VerificationError__IntermediateHashMismatch;
+  return VerificationError__Ok;
 }
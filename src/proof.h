@@ -1,11 +1,13 @@
 #ifndef PROOF_H
 #define PROOF_H
 
+#include "blake3_lanes.h"
 #include "challenge_id.h"
 #include "config.h"
 #include "hashmap.h"
 #include "memory.h"
 #include "merkle_tree.h"
+#include "search.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -31,17 +33,39 @@ typedef enum VerificationError {
 /**
  * @brief A cryptographic Proof-of-Work (PoW) solution for the Itsuku scheme.
  * * Endianness field is implicitly Little Endian.
+ *
+ * The collective opening is stored in contiguous, index-sorted arrays so
+ * lookups are binary searches and a proof costs a handful of allocations.
  */
 typedef struct Proof {
   Config config;
   ChallengeId challenge_id;
   uint64_t nonce;
 
-  // map from leaf index (usize) to the list of Elements (Vec<Element>)
-  HashMap leaf_antecedents;
+  /** Number of distinct opened leaves. */
+  size_t leaf_count;
+  /** Opened leaf indices (memory element indices), strictly ascending. */
+  size_t *leaf_indices;
+  /**
+   * Packed antecedents, config.antecedent_count slots per leaf in
+   * leaf_indices order. Leaves in the initialization phase of their chunk
+   * use only the first slot (see Proof__antecedent_count_for_leaf).
+   */
+  Element *leaf_antecedents;
 
-  // map from Merkle node index (usize) to its hash (Bytes)
-  HashMap tree_opening;
+  /** Number of nodes in the Merkle multiproof. */
+  size_t node_count;
+  /** Merkle node indices of the multiproof, strictly ascending. */
+  size_t *node_indices;
+  /** Packed node hashes, node_size bytes each, in node_indices order. */
+  uint8_t *node_hashes;
+
+  /**
+   * The Merkle root the proof claims, node_size bytes. It seeds the Omega
+   * walk, so the difficulty can be checked before any tree hashing; the
+   * multiproof must then reproduce it.
+   */
+  uint8_t *root_hash;
 } Proof;
 
 // --- Funkcje dla Proof ---
@@ -49,16 +73,200 @@ typedef struct Proof {
 /**
  * @brief Initiates a multi-threaded nonce search for a valid proof.
  * * Proof::search(config, challenge_id, memory, merkle_tree)
+ *
+ * Uses SearchOptions__default(), so the lowest valid nonce is returned.
  * @return The first valid Proof found (dynamically allocated).
  */
 Proof *Proof__search(Config config, const ChallengeId *challenge_id,
                      const Memory *memory, const MerkleTree *merkle_tree);
 
+/**
+ * @brief Nonce search with explicit engine options.
+ *
+ * Worker threads claim disjoint batches of nonces from a shared counter and
+ * publish a winner with an atomic compare-exchange; memory and merkle_tree
+ * are only read. Passing NULL options is the same as Proof__search.
+ * @return The winning Proof (dynamically allocated), or NULL on failure.
+ */
+Proof *Proof__search_with_options(Config config,
+                                  const ChallengeId *challenge_id,
+                                  const Memory *memory,
+                                  const MerkleTree *merkle_tree,
+                                  const SearchOptions *options);
+
+/**
+ * @brief Searches the nonces start, start + stride, ... below end.
+ *
+ * Lets several processes or hosts split one challenge into disjoint ranges
+ * (e.g. worker i of n uses start = i, stride = n) and resume exactly where a
+ * worker stopped. `end` is exclusive; stride 0 is treated as 1. Passing NULL
+ * options selects SearchOptions__default().
+ */
+SearchResult Proof__search_range(Config config,
+                                 const ChallengeId *challenge_id,
+                                 const Memory *memory,
+                                 const MerkleTree *merkle_tree, uint64_t start,
+                                 uint64_t end, uint64_t stride,
+                                 const SearchOptions *options);
+
+/**
+ * @brief Proof__search_range on the threads and scratch buffers of
+ * `workspace`; its thread count takes precedence over
+ * options->thread_count.
+ */
+SearchResult Proof__search_range_in(SearchWorkspace *workspace, Config config,
+                                    const ChallengeId *challenge_id,
+                                    const Memory *memory,
+                                    const MerkleTree *merkle_tree,
+                                    uint64_t start, uint64_t end,
+                                    uint64_t stride,
+                                    const SearchOptions *options);
+
+/**
+ * @brief Collects up to `max_solutions` valid nonces of the range and their
+ * proofs in one sweep.
+ *
+ * Workers keep going after a valid nonce and feed every winner into a
+ * bounded lock-free queue; the sweep stops once `max_solutions` of them were
+ * accepted or the range is exhausted. The proofs are written to
+ * `proofs_out` (room for max_solutions pointers, owned by the caller) in
+ * ascending nonce order and their number to `*solution_count`. With one
+ * thread they are the lowest valid nonces of the range; with more, which
+ * winners make it in depends on scheduling.
+ *
+ * @return status Found once all max_solutions were collected; otherwise why
+ * the sweep ended early, with the proofs collected so far still returned.
+ * result.proof is unused. last_nonce ends the evaluated prefix as for an
+ * interrupted search, so collected nonces above it come up again on resume.
+ */
+SearchResult Proof__search_many(Config config,
+                                const ChallengeId *challenge_id,
+                                const Memory *memory,
+                                const MerkleTree *merkle_tree, uint64_t start,
+                                uint64_t end, uint64_t stride,
+                                size_t max_solutions,
+                                const SearchOptions *options,
+                                Proof **proofs_out, size_t *solution_count);
+
+/**
+ * @brief Proof__search_many on the threads and scratch buffers of
+ * `workspace`.
+ */
+SearchResult Proof__search_many_in(SearchWorkspace *workspace, Config config,
+                                   const ChallengeId *challenge_id,
+                                   const Memory *memory,
+                                   const MerkleTree *merkle_tree,
+                                   uint64_t start, uint64_t end,
+                                   uint64_t stride, size_t max_solutions,
+                                   const SearchOptions *options,
+                                   Proof **proofs_out,
+                                   size_t *solution_count);
+
+/**
+ * @brief Incremental single-threaded search, driven one step at a time by
+ * the caller (see Proof__search_step).
+ */
+typedef struct SearchState SearchState;
+
+/**
+ * @brief Prepares a step-wise search of start, start + stride, ... below
+ * end. All scratch buffers are allocated here, so steps never allocate
+ * except to build a winning proof.
+ *
+ * Of `options` (NULL selects the defaults) only interleave and the share
+ * settings apply; threads, deadlines and progress are up to the caller's
+ * loop. The state borrows challenge_id, memory and merkle_tree.
+ * @return The state, or NULL on allocation failure or a missing root.
+ */
+SearchState *SearchState__new(Config config, const ChallengeId *challenge_id,
+                              const Memory *memory,
+                              const MerkleTree *merkle_tree, uint64_t start,
+                              uint64_t end, uint64_t stride,
+                              const SearchOptions *options);
+
+/**
+ * @brief Evaluates at most `max_nonces` nonces in sequence order, so the
+ * first valid nonce found is the lowest one left in the range.
+ *
+ * After SearchStep__Found the next step resumes just past the winner; an
+ * untaken proof is then dropped when the next winner is found.
+ */
+SearchStep Proof__search_step(SearchState *state, uint64_t max_nonces);
+
+/**
+ * @brief Hands over the proof of the last winner (NULL if there is none or
+ * it was already taken). The caller owns it.
+ */
+Proof *SearchState__take_proof(SearchState *self);
+
+/**
+ * @brief First nonce not evaluated yet; every earlier nonce of the range
+ * has been.
+ */
+uint64_t SearchState__next_nonce(const SearchState *self);
+
+/**
+ * @brief Nonces evaluated by all steps so far.
+ */
+uint64_t SearchState__nonces_tried(const SearchState *self);
+
+/**
+ * @brief Frees the state and any untaken proof. Safe to call with NULL.
+ */
+void SearchState__drop(SearchState *self);
+
+/**
+ * @brief Builds the Proof (collective opening) for a known nonce.
+ *
+ * Recomputes the Omega path to find the selected leaves. The nonce does not
+ * need to meet the difficulty; Proof__verify decides that.
+ * @return Dynamically allocated Proof, or NULL on allocation failure.
+ */
+Proof *Proof__from_nonce(const Config *config, const ChallengeId *challenge_id,
+                         const Memory *memory, const MerkleTree *merkle_tree,
+                         uint64_t nonce);
+
 /**
  * @brief Deallocates the Proof structure.
  */
 void Proof__drop(Proof *self);
 
+/**
+ * @brief Returns how many antecedents are opened for a leaf: 1 for elements
+ * in the initialization phase of their chunk, antecedent_count otherwise.
+ */
+size_t Proof__antecedent_count_for_leaf(const Config *config,
+                                        size_t leaf_index);
+
+/**
+ * @brief Looks up the opened antecedents of a leaf by binary search.
+ * @param count_out Optional output for the number of antecedents.
+ * @return Pointer into the proof, or NULL if the leaf is not opened.
+ */
+const Element *Proof__get_antecedents(const Proof *self, size_t leaf_index,
+                                      size_t *count_out);
+
+/**
+ * @brief Looks up a multiproof node hash by binary search.
+ * @return Pointer into the proof (node_size bytes), or NULL if absent.
+ */
+const uint8_t *Proof__get_node(const Proof *self, size_t node_index);
+
+/**
+ * @brief Compatibility view: leaf index -> Element* (the leaf's antecedents).
+ *
+ * Values point into the proof and stay valid while it lives; the map owns
+ * nothing but itself and must be released with HashMap__drop.
+ */
+HashMap Proof__leaf_antecedents_map(const Proof *self);
+
+/**
+ * @brief Compatibility view: Merkle node index -> node hash (uint8_t*).
+ *
+ * Same ownership rules as Proof__leaf_antecedents_map.
+ */
+HashMap Proof__tree_opening_map(const Proof *self);
+
 /**
  * @brief Calculates the final Omega hash for a given nonce.
  * * Proof::calculate_omega(...)
@@ -73,6 +281,78 @@ void Proof__calculate_omega(uint8_t omega_out[64],
                             const uint8_t root_hash[64], size_t memory_size,
                             uint64_t nonce);
 
+/**
+ * @brief Calculates the Omega hash into caller-provided buffers.
+ * @param selected_leaves_out Buffer of search_length leaf indices.
+ * @param path_hashes_out Buffer of search_length + 1 path hashes.
+ */
+void Proof__calculate_omega_no_alloc(
+    uint8_t omega_out[64], size_t selected_leaves_out[],
+    uint8_t path_hashes_out[][64], const Config *config,
+    const ChallengeId *challenge_id, PartialMemory_Wrapper memory_wrapper,
+    PartialMerkleTree_Wrapper merkle_tree_wrapper, const uint8_t root_hash[64],
+    size_t memory_size, uint64_t nonce);
+
+/** Largest number of nonces Proof__calculate_omega_interleaved keeps in
+ * flight. */
+#define OMEGA_MAX_IN_FLIGHT 64
+
+/**
+ * @brief Calculates the Omega hashes of up to OMEGA_MAX_IN_FLIGHT nonces,
+ * keeping all of them in flight.
+ *
+ * Nonces are hashed in groups of BLAKE3_LANE_COUNT lanes. As soon as a
+ * step reveals a nonce's next leaf, that element is prefetched, and the
+ * remaining groups are hashed while the load completes, so with enough
+ * nonces in flight the walk is no longer bound by memory latency.
+ *
+ * @param omega_out nonce_count output hashes.
+ * @param nonces nonce_count nonces to evaluate.
+ * @param path_scratch Buffer of nonce_count * (search_length + 1) hashes.
+ */
+void Proof__calculate_omega_interleaved(
+    uint8_t omega_out[][64], const uint64_t nonces[], size_t nonce_count,
+    uint8_t path_scratch[][64], const Config *config,
+    const ChallengeId *challenge_id, PartialMemory_Wrapper memory_wrapper,
+    const uint8_t root_hash[64], size_t memory_size);
+
+/**
+ * @brief Proof__calculate_omega_interleaved specialized for a full Memory:
+ * elements are read and prefetched through direct pointers instead of the
+ * PartialMemory_Wrapper callbacks. The memory size is taken from config,
+ * which must describe `memory`.
+ */
+void Proof__calculate_omega_full(uint8_t omega_out[][64],
+                                 const uint64_t nonces[], size_t nonce_count,
+                                 uint8_t path_scratch[][64],
+                                 const Config *config,
+                                 const ChallengeId *challenge_id,
+                                 const Memory *memory,
+                                 const uint8_t root_hash[64]);
+
+/**
+ * @brief Calculates the Omega hashes of up to BLAKE3_LANE_COUNT nonces in
+ * lockstep: Y0 of every nonce, then each path step of every nonce, each as
+ * one multi-lane BLAKE3 call. Produces the same hashes as
+ * Proof__calculate_omega_no_alloc.
+ *
+ * @param omega_out lane_count output hashes.
+ * @param nonces lane_count nonces to evaluate.
+ * @param path_scratch Buffer of lane_count * (search_length + 1) hashes.
+ */
+void Proof__calculate_omega_lanes(
+    uint8_t omega_out[][64], const uint64_t nonces[], size_t lane_count,
+    uint8_t path_scratch[][64], const Config *config,
+    const ChallengeId *challenge_id, PartialMemory_Wrapper memory_wrapper,
+    const uint8_t root_hash[64], size_t memory_size);
+
+/**
+ * @brief Copies the Merkle root into a zero-padded 64-byte buffer, the form
+ * in which it enters the Omega hash.
+ * @return false if the tree has no root node.
+ */
+bool Proof__padded_root(const MerkleTree *merkle_tree, uint8_t root_out[64]);
+
 /**
  * @brief Counts the number of leading zero bits in a byte array.
  */
@@ -81,8 +361,32 @@ size_t Proof__leading_zeros(const uint8_t *array, size_t size);
 /**
  * @brief Verifies the PoW proof against the challenge and configuration.
  * * Proof::verify(&self)
+ *
+ * Checks run cheapest first and stop at the first failure: index ranges
+ * and the completeness of the opening (no hashing), then the Omega walk
+ * and difficulty against the claimed root, and last the leaf hashes and
+ * the Merkle paths, which must reproduce that root.
  * @return VerificationError__Ok if valid, or a specific error otherwise.
  */
 VerificationError Proof__verify(const Proof *self);
 
+/**
+ * @brief Bytes of scratch Proof__verify_in needs for proofs under `config`.
+ */
+size_t Proof__verify_scratch_size(const Config *config);
+
+/**
+ * @brief Proof__verify without heap allocation.
+ *
+ * All intermediate state (reconstructed elements, leaf and derived node
+ * hashes, the Omega path) lives in `scratch`, which must be suitably
+ * aligned for 8-byte words (malloc'd memory is) and hold at least
+ * Proof__verify_scratch_size(&self->config) bytes. Opened leaves and nodes
+ * are found by binary search in the proof's sorted index arrays.
+ * @return As Proof__verify; VerificationError__RequiredElementMissing if
+ * the scratch is too small.
+ */
+VerificationError Proof__verify_in(const Proof *self, void *scratch,
+                                   size_t scratch_size);
+
 #endif // PROOF_H
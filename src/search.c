@@ -0,0 +1,955 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime, nanosleep
+
+#include "search.h"
+#include "cpu_quota.h"
+#include "nonce_queue.h"
+#include "proof.h"
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OMEGA_HASH_SIZE 64
+#define DEFAULT_BATCH_SIZE 256
+#define DEFAULT_INTERLEAVE 16
+#define NO_INDEX UINT64_MAX
+#define DUTY_SLICE_NS 10000000ull // Work between rests of a throttled worker
+
+// =================================================================
+// SEARCH OPTIONS
+// =================================================================
+
+SearchOptions SearchOptions__default() {
+  return (SearchOptions){
+      .thread_count = 0,
+      .batch_size = DEFAULT_BATCH_SIZE,
+      .interleave = DEFAULT_INTERLEAVE,
+      .lowest_nonce = true,
+      .cancel_flag = NULL,
+      .deadline_seconds = 0.0,
+      .progress = NULL,
+      .progress_user_data = NULL,
+      .progress_interval = 0,
+      .share_difficulty_bits = 0,
+      .share = NULL,
+      .share_user_data = NULL,
+      .stats = NULL,
+      .duty_cycle = 0.0,
+  };
+}
+
+size_t SearchOptions__effective_thread_count(const SearchOptions *self) {
+  if (self->thread_count > 0)
+    return self->thread_count;
+
+  CpuQuota quota = CpuQuota__detect();
+  double budget = CpuQuota__budget(&quota);
+  size_t threads = (size_t)budget;
+  if ((double)threads < budget)
+    ++threads;
+  return threads > 0 ? threads : 1;
+}
+
+void SearchOptions__fit_cpu_quota(SearchOptions *self, double cpu_share) {
+  if (cpu_share <= 0 || cpu_share > 1)
+    cpu_share = 1;
+  CpuQuota quota = CpuQuota__detect();
+  double target = CpuQuota__budget(&quota) * cpu_share;
+
+  size_t threads = (size_t)target;
+  if ((double)threads < target)
+    ++threads;
+  if (threads == 0)
+    threads = 1;
+  self->thread_count = threads;
+  self->duty_cycle = target / (double)threads;
+}
+
+// =================================================================
+// SEARCH WORKSPACE
+// =================================================================
+
+SearchWorkspace *SearchWorkspace__new(size_t thread_count) {
+  SearchWorkspace *self = (SearchWorkspace *)calloc(1, sizeof(SearchWorkspace));
+  if (!self)
+    return NULL;
+
+  self->pool = ThreadPool__new(thread_count);
+  if (!self->pool) {
+    free(self);
+    return NULL;
+  }
+
+  self->positions = (_Atomic uint64_t *)calloc(
+      ThreadPool__thread_count(self->pool), sizeof(_Atomic uint64_t));
+  if (!self->positions) {
+    ThreadPool__drop(self->pool);
+    free(self);
+    return NULL;
+  }
+  return self;
+}
+
+size_t SearchWorkspace__thread_count(const SearchWorkspace *self) {
+  return ThreadPool__thread_count(self->pool);
+}
+
+/**
+ * @brief Makes sure every worker has room for `hashes` scratch hashes.
+ */
+static bool SearchWorkspace__reserve(SearchWorkspace *self, size_t hashes) {
+  if (hashes <= self->scratch_hashes)
+    return true;
+
+  size_t total = SearchWorkspace__thread_count(self) * hashes;
+  uint8_t *scratch = (uint8_t *)malloc(total * OMEGA_HASH_SIZE);
+  if (!scratch)
+    return false;
+
+  free(self->scratch);
+  self->scratch = scratch;
+  self->scratch_hashes = hashes;
+  return true;
+}
+
+void SearchWorkspace__drop(SearchWorkspace *self) {
+  if (!self)
+    return;
+  ThreadPool__drop(self->pool);
+  free(self->positions);
+  free(self->scratch);
+  free(self);
+}
+
+// =================================================================
+// SEARCH ENGINE
+// =================================================================
+
+static uint64_t monotonic_ns() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static double monotonic_seconds() { return (double)monotonic_ns() / 1e9; }
+
+// =================================================================
+// SEARCH STATISTICS
+// =================================================================
+
+void SearchStats__reset(SearchStats *self) {
+  atomic_store(&self->nonces_evaluated, 0);
+  atomic_store(&self->element_reads, 0);
+  atomic_store(&self->best_leading_zeros, 0);
+  atomic_store(&self->thread_count, 0);
+  for (size_t i = 0; i < SEARCH_STATS_MAX_THREADS; ++i) {
+    atomic_store(&self->thread_nonces[i], 0);
+  }
+  atomic_store(&self->started_ns, 0);
+  atomic_store(&self->finished_ns, 0);
+  atomic_store(&self->solution_ns, 0);
+  atomic_store(&self->shares_found, 0);
+}
+
+double SearchStats__elapsed_seconds(const SearchStats *self) {
+  uint64_t started = atomic_load(&self->started_ns);
+  if (started == 0)
+    return 0.0;
+
+  uint64_t finished = atomic_load(&self->finished_ns);
+  uint64_t end = finished ? finished : monotonic_ns();
+  return (double)(end - started) / 1e9;
+}
+
+double SearchStats__hashrate(const SearchStats *self) {
+  double elapsed = SearchStats__elapsed_seconds(self);
+  if (elapsed <= 0)
+    return 0.0;
+  return (double)atomic_load(&self->nonces_evaluated) / elapsed;
+}
+
+double SearchStats__time_to_solution(const SearchStats *self) {
+  uint64_t solution = atomic_load(&self->solution_ns);
+  return solution ? (double)solution / 1e9 : -1.0;
+}
+
+void SearchStats__print(const SearchStats *self, FILE *out) {
+  size_t threads = atomic_load(&self->thread_count);
+  fprintf(out, "  Nonces Evaluated: %llu\n",
+          (unsigned long long)atomic_load(&self->nonces_evaluated));
+  fprintf(out, "  Element Reads: %llu\n",
+          (unsigned long long)atomic_load(&self->element_reads));
+  fprintf(out, "  Best Leading Zeros: %zu\n",
+          atomic_load(&self->best_leading_zeros));
+  fprintf(out, "  Wall Time: %.4f s\n", SearchStats__elapsed_seconds(self));
+  fprintf(out, "  Hashrate: %.0f H/s\n", SearchStats__hashrate(self));
+
+  uint64_t shares = atomic_load(&self->shares_found);
+  if (shares > 0)
+    fprintf(out, "  Shares Found: %llu\n", (unsigned long long)shares);
+
+  double solution = SearchStats__time_to_solution(self);
+  if (solution >= 0)
+    fprintf(out, "  Time to Solution: %.4f s\n", solution);
+
+  if (threads > SEARCH_STATS_MAX_THREADS)
+    threads = SEARCH_STATS_MAX_THREADS;
+  for (size_t i = 0; i < threads; ++i) {
+    fprintf(out, "  Thread %zu Nonces: %llu\n", i,
+            (unsigned long long)atomic_load(&self->thread_nonces[i]));
+  }
+}
+
+/** Why the workers stopped early. */
+typedef enum SearchHalt {
+  SearchHalt__None = 0,
+  SearchHalt__Cancelled,
+  SearchHalt__Deadline,
+  SearchHalt__Satisfied, // A multi-solution search has all it asked for
+} SearchHalt;
+
+/**
+ * @brief State shared by all workers of one search.
+ *
+ * The range is walked as a sequence: position k stands for nonce
+ * start_nonce + k * stride. Workers claim batches of positions from
+ * `next_index` and publish winners into `found_index` (NO_INDEX while
+ * nothing has been found).
+ *
+ * An interrupted worker records the first position it did not evaluate in
+ * `resume_index`, so the caller can tell which prefix of the range is done.
+ * While the search runs, each worker keeps a lower bound of the next
+ * position it will evaluate in the workspace's `positions`, which gives the
+ * live frontier reported to the progress callback.
+ *
+ * A multi-solution search leaves `found_index` alone: winners go to the
+ * `solutions` queue instead, and the workers halt once `max_solutions` of
+ * them were accepted.
+ */
+typedef struct SearchShared {
+  const Config *config;
+  const ChallengeId *challenge_id;
+  const Memory *memory;
+  const uint8_t *root_hash;
+  uint64_t batch_size;
+  size_t interleave;
+  uint64_t start_nonce;
+  uint64_t stride;
+  uint64_t index_count;
+  bool lowest_nonce;
+
+  const atomic_bool *cancel_flag;
+  double deadline_at; // 0 when there is no deadline
+  SearchProgressCallback progress;
+  void *progress_user_data;
+  uint64_t progress_interval;
+  double duty_cycle; // 0 when workers are not throttled
+  size_t share_difficulty_bits;
+  SearchShareCallback share; // NULL when shares are disabled
+  void *share_user_data;
+  pthread_mutex_t progress_lock; // Serializes progress and share callbacks
+  SearchStats *stats; // The caller's, or one owned by the search
+  SearchWorkspace *workspace;
+
+  _Atomic uint64_t next_index;
+  _Atomic uint64_t found_index;
+  _Atomic uint64_t resume_index;
+  _Atomic int halt;
+
+  NonceQueue *solutions; // NULL outside multi-solution search
+  uint64_t max_solutions;
+  _Atomic uint64_t solutions_accepted;
+} SearchShared;
+
+
+/**
+ * @brief Records the time to the first solution.
+ */
+static void SearchShared__mark_solution(SearchShared *self) {
+  uint64_t none = 0;
+  atomic_compare_exchange_strong(
+      &self->stats->solution_ns, &none,
+      monotonic_ns() - atomic_load(&self->stats->started_ns));
+}
+
+/**
+ * @brief Publishes a valid sequence position.
+ *
+ * In lowest-nonce mode the stored value only ever decreases, so concurrent
+ * winners settle on the minimum. Otherwise only the first winner is kept.
+ */
+static void SearchShared__publish(SearchShared *self, uint64_t index) {
+  SearchShared__mark_solution(self);
+
+  uint64_t current = atomic_load(&self->found_index);
+  if (!self->lowest_nonce) {
+    atomic_compare_exchange_strong(&self->found_index, &current, index);
+    return;
+  }
+  while (index < current &&
+         !atomic_compare_exchange_weak(&self->found_index, &current, index)) {
+  }
+}
+
+static void atomic_store_min(_Atomic uint64_t *target, uint64_t value) {
+  uint64_t current = atomic_load(target);
+  while (value < current &&
+         !atomic_compare_exchange_weak(target, &current, value)) {
+  }
+}
+
+/**
+ * @brief Queues a valid position of a multi-solution search and halts the
+ * workers once the last wanted one is in.
+ */
+static void SearchShared__collect(SearchShared *self, uint64_t index) {
+  SearchShared__mark_solution(self);
+  uint64_t accepted = atomic_fetch_add(&self->solutions_accepted, 1);
+  if (accepted >= self->max_solutions)
+    return; // Another worker took the last slot
+
+  NonceQueue__push(self->solutions, index);
+  if (accepted + 1 == self->max_solutions) {
+    int expected = SearchHalt__None;
+    atomic_compare_exchange_strong(&self->halt, &expected,
+                                   SearchHalt__Satisfied);
+  }
+}
+
+/**
+ * @brief Returns true once no position at or above `index` can win any more.
+ */
+static bool SearchShared__should_stop(SearchShared *self, uint64_t index) {
+  if (atomic_load_explicit(&self->halt, memory_order_relaxed)) {
+    atomic_store_min(&self->resume_index, index);
+    return true;
+  }
+
+  uint64_t found =
+      atomic_load_explicit(&self->found_index, memory_order_relaxed);
+  if (found == NO_INDEX)
+    return false;
+  return !self->lowest_nonce || index > found;
+}
+
+/**
+ * @brief Polls the cancellation flag and the deadline before evaluating
+ * `index`. On a halt, records `index` as not evaluated and returns true.
+ */
+static bool SearchShared__check_halt(SearchShared *self, uint64_t index) {
+  int halt = atomic_load_explicit(&self->halt, memory_order_relaxed);
+  if (halt == SearchHalt__None) {
+    if (self->cancel_flag &&
+        atomic_load_explicit(self->cancel_flag, memory_order_relaxed))
+      halt = SearchHalt__Cancelled;
+    else if (self->deadline_at > 0 && monotonic_seconds() >= self->deadline_at)
+      halt = SearchHalt__Deadline;
+
+    if (halt != SearchHalt__None) {
+      int expected = SearchHalt__None;
+      atomic_compare_exchange_strong(&self->halt, &expected, halt);
+    }
+  }
+
+  if (halt == SearchHalt__None)
+    return false;
+  atomic_store_min(&self->resume_index, index);
+  return true;
+}
+
+/**
+ * @brief Returns a position such that every position below it has been
+ * evaluated: the lowest one any worker may still be working on.
+ */
+static uint64_t SearchShared__frontier(SearchShared *self) {
+  uint64_t frontier = atomic_load(&self->next_index);
+  size_t workers = SearchWorkspace__thread_count(self->workspace);
+  for (size_t i = 0; i < workers; ++i) {
+    uint64_t position = atomic_load(&self->workspace->positions[i]);
+    if (position < frontier)
+      frontier = position;
+  }
+  return frontier < self->index_count ? frontier : self->index_count;
+}
+
+/**
+ * @brief Accounts for `count` evaluated nonces and fires the progress
+ * callback when the global count crosses a multiple of the reporting
+ * interval.
+ */
+static void SearchShared__record(SearchShared *self, size_t worker_id,
+                                 uint64_t count, size_t leading_zeros) {
+  SearchStats *stats = self->stats;
+  size_t best =
+      atomic_load_explicit(&stats->best_leading_zeros, memory_order_relaxed);
+  while (leading_zeros > best &&
+         !atomic_compare_exchange_weak(&stats->best_leading_zeros, &best,
+                                       leading_zeros)) {
+  }
+
+  size_t slot = worker_id < SEARCH_STATS_MAX_THREADS
+                    ? worker_id
+                    : SEARCH_STATS_MAX_THREADS - 1;
+  atomic_fetch_add_explicit(&stats->thread_nonces[slot], count,
+                            memory_order_relaxed);
+  atomic_fetch_add_explicit(&stats->element_reads,
+                            count * self->config->search_length,
+                            memory_order_relaxed);
+  uint64_t before = atomic_fetch_add_explicit(&stats->nonces_evaluated, count,
+                                              memory_order_relaxed);
+  uint64_t tried = before + count;
+  if (!self->progress ||
+      tried / self->progress_interval == before / self->progress_interval)
+    return;
+
+  pthread_mutex_lock(&self->progress_lock);
+  SearchProgress progress = {
+      .nonces_tried = tried,
+      .next_nonce =
+          self->start_nonce + SearchShared__frontier(self) * self->stride,
+      .best_leading_zeros = atomic_load(&stats->best_leading_zeros),
+      .elapsed_seconds = SearchStats__elapsed_seconds(stats),
+  };
+  self->progress(&progress, self->progress_user_data);
+  pthread_mutex_unlock(&self->progress_lock);
+}
+
+/**
+ * @brief Hands a nonce that met the share difficulty to the share callback.
+ */
+static void SearchShared__report_share(SearchShared *self, uint64_t nonce,
+                                       size_t leading_zeros,
+                                       const uint8_t *omega) {
+  atomic_fetch_add_explicit(&self->stats->shares_found, 1,
+                            memory_order_relaxed);
+  SearchShare share = {
+      .nonce = nonce, .leading_zeros = leading_zeros, .omega = omega};
+  pthread_mutex_lock(&self->progress_lock);
+  self->share(&share, self->share_user_data);
+  pthread_mutex_unlock(&self->progress_lock);
+}
+
+/**
+ * @brief Keeps a throttled worker to the duty cycle: after each slice of
+ * work it sleeps long enough for searching to take `duty_cycle` of its
+ * time. The rest is cut short when the search halts or is cancelled.
+ */
+static void SearchShared__rest(SearchShared *self, uint64_t *busy_since) {
+  uint64_t busy = monotonic_ns() - *busy_since;
+  if (busy < DUTY_SLICE_NS)
+    return;
+
+  uint64_t rest =
+      (uint64_t)((double)busy * (1.0 - self->duty_cycle) / self->duty_cycle);
+  while (rest > 0 &&
+         !atomic_load_explicit(&self->halt, memory_order_relaxed) &&
+         !(self->cancel_flag &&
+           atomic_load_explicit(self->cancel_flag, memory_order_relaxed))) {
+    uint64_t nap = rest < DUTY_SLICE_NS ? rest : DUTY_SLICE_NS;
+    struct timespec pause = {.tv_sec = 0, .tv_nsec = (long)nap};
+    nanosleep(&pause, NULL);
+    rest -= nap;
+  }
+  *busy_since = monotonic_ns();
+}
+
+static void SearchShared__worker(void *arg, size_t worker_id) {
+  SearchShared *self = (SearchShared *)arg;
+  SearchWorkspace *workspace = self->workspace;
+  size_t K = self->interleave;
+
+  uint8_t (*path_scratch)[OMEGA_HASH_SIZE] =
+      (uint8_t (*)[OMEGA_HASH_SIZE])&workspace
+          ->scratch[worker_id * workspace->scratch_hashes * OMEGA_HASH_SIZE];
+
+  _Atomic uint64_t *position = &workspace->positions[worker_id];
+
+  uint64_t nonces[OMEGA_MAX_IN_FLIGHT];
+  uint8_t omegas[OMEGA_MAX_IN_FLIGHT][OMEGA_HASH_SIZE];
+  uint64_t busy_since = monotonic_ns();
+  for (;;) {
+    // Publish a lower bound of the claim before making it, so the frontier
+    // never passes a batch that is claimed but not yet published
+    atomic_store(position, atomic_load(&self->next_index));
+    uint64_t first = atomic_fetch_add(&self->next_index, self->batch_size);
+    atomic_store(position, first);
+    if (first >= self->index_count || SearchShared__should_stop(self, first))
+      break;
+    if (SearchShared__check_halt(self, first))
+      break;
+
+    uint64_t last = self->index_count - first < self->batch_size
+                        ? self->index_count
+                        : first + self->batch_size;
+
+    // Nonces of a batch are evaluated K at a time
+    bool batch_done = false;
+    for (uint64_t index = first; index < last && !batch_done; index += K) {
+      if (SearchShared__should_stop(self, index) ||
+          SearchShared__check_halt(self, index))
+        break;
+
+      size_t in_flight = last - index < K ? (size_t)(last - index) : K;
+      for (size_t l = 0; l < in_flight; ++l) {
+        nonces[l] = self->start_nonce + (index + l) * self->stride;
+      }
+      Proof__calculate_omega_full(omegas, nonces, in_flight, path_scratch,
+                                  self->config, self->challenge_id,
+                                  self->memory, self->root_hash);
+
+      size_t best = 0;
+      for (size_t l = 0; l < in_flight; ++l) {
+        size_t leading_zeros = Proof__leading_zeros(omegas[l], OMEGA_HASH_SIZE);
+        if (leading_zeros > best)
+          best = leading_zeros;
+        if (self->share && leading_zeros >= self->share_difficulty_bits)
+          SearchShared__report_share(self, nonces[l], leading_zeros,
+                                     omegas[l]);
+
+        if (leading_zeros < self->config->difficulty_bits)
+          continue;
+        if (self->solutions) {
+          SearchShared__collect(self, index + l);
+        } else if (!batch_done) {
+          SearchShared__publish(self, index + l);
+          batch_done = true; // Later positions cannot beat this one
+        }
+      }
+      atomic_store(position, index + in_flight);
+      SearchShared__record(self, worker_id, in_flight, best);
+      if (self->duty_cycle > 0)
+        SearchShared__rest(self, &busy_since);
+    }
+  }
+}
+
+Proof *Proof__search(Config config, const ChallengeId *challenge_id,
+                     const Memory *memory, const MerkleTree *merkle_tree) {
+  return Proof__search_with_options(config, challenge_id, memory, merkle_tree,
+                                    NULL);
+}
+
+Proof *Proof__search_with_options(Config config,
+                                  const ChallengeId *challenge_id,
+                                  const Memory *memory,
+                                  const MerkleTree *merkle_tree,
+                                  const SearchOptions *options) {
+  SearchResult result = Proof__search_range(
+      config, challenge_id, memory, merkle_tree, 1, UINT64_MAX, 1, options);
+  return result.status == SearchStatus__Found ? result.proof : NULL;
+}
+
+SearchResult Proof__search_range(Config config,
+                                 const ChallengeId *challenge_id,
+                                 const Memory *memory,
+                                 const MerkleTree *merkle_tree, uint64_t start,
+                                 uint64_t end, uint64_t stride,
+                                 const SearchOptions *options) {
+  SearchOptions defaults = SearchOptions__default();
+  if (!options)
+    options = &defaults;
+
+  SearchWorkspace *workspace =
+      SearchWorkspace__new(SearchOptions__effective_thread_count(options));
+  if (!workspace) {
+    return (SearchResult){
+        .status = SearchStatus__Error, .proof = NULL, .last_nonce = start};
+  }
+
+  SearchResult result =
+      Proof__search_range_in(workspace, config, challenge_id, memory,
+                             merkle_tree, start, end, stride, options);
+  SearchWorkspace__drop(workspace);
+  return result;
+}
+
+/**
+ * @brief Fills in `shared` for a sweep of start, start + stride, ... below
+ * end and resets the statistics.
+ * @return false if the workspace scratch cannot grow.
+ */
+static bool SearchShared__init(SearchShared *shared,
+                               SearchWorkspace *workspace, const Config *config,
+                               const ChallengeId *challenge_id,
+                               const Memory *memory, const uint8_t *root_hash,
+                               uint64_t start, uint64_t end, uint64_t stride,
+                               const SearchOptions *options,
+                               SearchStats *own_stats) {
+  *shared = (SearchShared){
+      .config = config,
+      .challenge_id = challenge_id,
+      .memory = memory,
+      .root_hash = root_hash,
+      .workspace = workspace,
+      .batch_size = options->batch_size > 0 ? options->batch_size
+                                            : DEFAULT_BATCH_SIZE,
+      .interleave = options->interleave > 0 ? options->interleave
+                                            : DEFAULT_INTERLEAVE,
+      .start_nonce = start,
+      .stride = stride,
+      .index_count = end > start ? (end - start - 1) / stride + 1 : 0,
+      .lowest_nonce = options->lowest_nonce,
+      .cancel_flag = options->cancel_flag,
+      .progress = options->progress,
+      .progress_user_data = options->progress_user_data,
+      .duty_cycle = options->duty_cycle > 0 && options->duty_cycle < 1
+                        ? options->duty_cycle
+                        : 0.0,
+      .share_difficulty_bits = options->share_difficulty_bits,
+      .share = options->share_difficulty_bits > 0 ? options->share : NULL,
+      .share_user_data = options->share_user_data,
+  };
+  shared->stats = options->stats ? options->stats : own_stats;
+  SearchStats__reset(shared->stats);
+  atomic_store(&shared->stats->started_ns, monotonic_ns());
+
+  shared->deadline_at = options->deadline_seconds > 0
+                            ? monotonic_seconds() + options->deadline_seconds
+                            : 0;
+  if (shared->interleave > OMEGA_MAX_IN_FLIGHT)
+    shared->interleave = OMEGA_MAX_IN_FLIGHT;
+  size_t scratch_hashes = shared->interleave * (config->search_length + 1);
+  if (!SearchWorkspace__reserve(workspace, scratch_hashes))
+    return false;
+  shared->progress_interval = options->progress_interval > 0
+                                  ? options->progress_interval
+                                  : shared->batch_size;
+  atomic_init(&shared->next_index, 0);
+  atomic_init(&shared->found_index, NO_INDEX);
+  atomic_init(&shared->resume_index, NO_INDEX);
+  atomic_init(&shared->halt, SearchHalt__None);
+  atomic_init(&shared->solutions_accepted, 0);
+  for (size_t i = 0; i < SearchWorkspace__thread_count(workspace); ++i) {
+    atomic_store(&workspace->positions[i], 0);
+  }
+  return true;
+}
+
+/**
+ * @brief Runs the workers of `workspace` over the range of `shared`.
+ */
+static void SearchShared__sweep(SearchShared *shared) {
+  atomic_store(&shared->stats->thread_count,
+               SearchWorkspace__thread_count(shared->workspace));
+  pthread_mutex_init(&shared->progress_lock, NULL);
+  ThreadPool__run(shared->workspace->pool, SearchShared__worker, shared);
+  pthread_mutex_destroy(&shared->progress_lock);
+  atomic_store(&shared->stats->finished_ns, monotonic_ns());
+}
+
+/**
+ * @brief Returns the end of the evaluated prefix of a finished sweep: every
+ * position below it was evaluated.
+ */
+static uint64_t SearchShared__resume_index(SearchShared *self) {
+  // Everything below the first unevaluated position (or the first unclaimed
+  // one) is done
+  uint64_t resume = atomic_load(&self->resume_index);
+  uint64_t claimed = atomic_load(&self->next_index);
+  if (claimed < resume)
+    resume = claimed;
+  if (self->index_count < resume)
+    resume = self->index_count;
+  return resume;
+}
+
+/**
+ * @brief Maps the halt reason of a finished sweep to the status of a search
+ * that did not get what it asked for.
+ */
+static SearchStatus SearchShared__shortfall_status(SearchShared *self) {
+  switch (atomic_load(&self->halt)) {
+  case SearchHalt__Cancelled:
+    return SearchStatus__Cancelled;
+  case SearchHalt__Deadline:
+    return SearchStatus__DeadlineExceeded;
+  default:
+    return SearchStatus__NotFoundInRange;
+  }
+}
+
+SearchResult Proof__search_range_in(SearchWorkspace *workspace, Config config,
+                                    const ChallengeId *challenge_id,
+                                    const Memory *memory,
+                                    const MerkleTree *merkle_tree,
+                                    uint64_t start, uint64_t end,
+                                    uint64_t stride,
+                                    const SearchOptions *options) {
+  SearchOptions defaults = SearchOptions__default();
+  if (!options)
+    options = &defaults;
+  if (stride == 0)
+    stride = 1;
+
+  SearchResult result = {
+      .status = SearchStatus__Error, .proof = NULL, .last_nonce = start};
+
+  uint8_t root_hash[OMEGA_HASH_SIZE];
+  if (!Proof__padded_root(merkle_tree, root_hash))
+    return result;
+
+  SearchShared shared;
+  SearchStats own_stats;
+  if (!SearchShared__init(&shared, workspace, &config, challenge_id, memory,
+                          root_hash, start, end, stride, options, &own_stats))
+    return result;
+
+  SearchShared__sweep(&shared);
+  result.nonces_tried = atomic_load(&shared.stats->nonces_evaluated);
+
+  uint64_t index = atomic_load(&shared.found_index);
+  if (index == NO_INDEX) {
+    result.status = SearchShared__shortfall_status(&shared);
+    result.last_nonce =
+        start + SearchShared__resume_index(&shared) * stride - stride;
+    return result;
+  }
+
+  result.last_nonce = start + index * stride;
+  result.proof = Proof__from_nonce(&config, challenge_id, memory, merkle_tree,
+                                   result.last_nonce);
+  result.status = result.proof ? SearchStatus__Found : SearchStatus__Error;
+  return result;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+SearchResult Proof__search_many(Config config,
+                                const ChallengeId *challenge_id,
+                                const Memory *memory,
+                                const MerkleTree *merkle_tree, uint64_t start,
+                                uint64_t end, uint64_t stride,
+                                size_t max_solutions,
+                                const SearchOptions *options,
+                                Proof **proofs_out, size_t *solution_count) {
+  *solution_count = 0;
+  SearchOptions defaults = SearchOptions__default();
+  if (!options)
+    options = &defaults;
+
+  SearchWorkspace *workspace =
+      SearchWorkspace__new(SearchOptions__effective_thread_count(options));
+  if (!workspace) {
+    return (SearchResult){
+        .status = SearchStatus__Error, .proof = NULL, .last_nonce = start};
+  }
+
+  SearchResult result = Proof__search_many_in(
+      workspace, config, challenge_id, memory, merkle_tree, start, end, stride,
+      max_solutions, options, proofs_out, solution_count);
+  SearchWorkspace__drop(workspace);
+  return result;
+}
+
+SearchResult Proof__search_many_in(SearchWorkspace *workspace, Config config,
+                                   const ChallengeId *challenge_id,
+                                   const Memory *memory,
+                                   const MerkleTree *merkle_tree,
+                                   uint64_t start, uint64_t end,
+                                   uint64_t stride, size_t max_solutions,
+                                   const SearchOptions *options,
+                                   Proof **proofs_out,
+                                   size_t *solution_count) {
+  *solution_count = 0;
+  SearchOptions defaults = SearchOptions__default();
+  if (!options)
+    options = &defaults;
+  if (stride == 0)
+    stride = 1;
+
+  SearchResult result = {
+      .status = SearchStatus__Error, .proof = NULL, .last_nonce = start};
+  if (max_solutions == 0)
+    return result;
+
+  uint8_t root_hash[OMEGA_HASH_SIZE];
+  if (!Proof__padded_root(merkle_tree, root_hash))
+    return result;
+
+  SearchShared shared;
+  SearchStats own_stats;
+  if (!SearchShared__init(&shared, workspace, &config, challenge_id, memory,
+                          root_hash, start, end, stride, options, &own_stats))
+    return result;
+  uint64_t *indices = (uint64_t *)malloc(max_solutions * sizeof(uint64_t));
+  shared.solutions = NonceQueue__new(max_solutions);
+  shared.max_solutions = max_solutions;
+  if (!indices || !shared.solutions) {
+    free(indices);
+    NonceQueue__drop(shared.solutions);
+    return result;
+  }
+
+  SearchShared__sweep(&shared);
+  result.nonces_tried = atomic_load(&shared.stats->nonces_evaluated);
+  result.last_nonce =
+      start + SearchShared__resume_index(&shared) * stride - stride;
+
+  size_t count = 0;
+  while (count < max_solutions &&
+         NonceQueue__pop(shared.solutions, &indices[count])) {
+    ++count;
+  }
+  NonceQueue__drop(shared.solutions);
+  qsort(indices, count, sizeof(uint64_t), compare_u64);
+
+  result.status = count == max_solutions
+                      ? SearchStatus__Found
+                      : SearchShared__shortfall_status(&shared);
+  for (size_t i = 0; i < count; ++i) {
+    proofs_out[i] = Proof__from_nonce(&config, challenge_id, memory,
+                                      merkle_tree, start + indices[i] * stride);
+    if (!proofs_out[i]) {
+      result.status = SearchStatus__Error;
+      break;
+    }
+    ++*solution_count;
+  }
+  free(indices);
+  return result;
+}
+
+// =================================================================
+// STEP-WISE SEARCH
+// =================================================================
+
+struct SearchState {
+  Config config;
+  const ChallengeId *challenge_id;
+  const Memory *memory;
+  const MerkleTree *merkle_tree;
+  uint8_t root_hash[OMEGA_HASH_SIZE];
+  uint64_t start_nonce;
+  uint64_t stride;
+  uint64_t index_count;
+  uint64_t next_index;
+  uint64_t nonces_tried;
+  size_t interleave;
+
+  size_t share_difficulty_bits;
+  SearchShareCallback share; // NULL when shares are disabled
+  void *share_user_data;
+
+  uint8_t (*path_scratch)[OMEGA_HASH_SIZE]; // interleave * (L + 1) hashes
+  Proof *proof;                             // Last untaken winner
+};
+
+SearchState *SearchState__new(Config config, const ChallengeId *challenge_id,
+                              const Memory *memory,
+                              const MerkleTree *merkle_tree, uint64_t start,
+                              uint64_t end, uint64_t stride,
+                              const SearchOptions *options) {
+  SearchOptions defaults = SearchOptions__default();
+  if (!options)
+    options = &defaults;
+  if (stride == 0)
+    stride = 1;
+
+  SearchState *self = (SearchState *)calloc(1, sizeof(SearchState));
+  if (!self)
+    return NULL;
+  if (!Proof__padded_root(merkle_tree, self->root_hash)) {
+    free(self);
+    return NULL;
+  }
+
+  self->config = config;
+  self->challenge_id = challenge_id;
+  self->memory = memory;
+  self->merkle_tree = merkle_tree;
+  self->start_nonce = start;
+  self->stride = stride;
+  self->index_count = end > start ? (end - start - 1) / stride + 1 : 0;
+  self->interleave =
+      options->interleave > 0 ? options->interleave : DEFAULT_INTERLEAVE;
+  if (self->interleave > OMEGA_MAX_IN_FLIGHT)
+    self->interleave = OMEGA_MAX_IN_FLIGHT;
+  self->share_difficulty_bits = options->share_difficulty_bits;
+  self->share = options->share_difficulty_bits > 0 ? options->share : NULL;
+  self->share_user_data = options->share_user_data;
+
+  self->path_scratch = (uint8_t (*)[OMEGA_HASH_SIZE])malloc(
+      self->interleave * (config.search_length + 1) * OMEGA_HASH_SIZE);
+  if (!self->path_scratch) {
+    free(self);
+    return NULL;
+  }
+  return self;
+}
+
+SearchStep Proof__search_step(SearchState *self, uint64_t max_nonces) {
+  uint64_t nonces[OMEGA_MAX_IN_FLIGHT];
+  uint8_t omegas[OMEGA_MAX_IN_FLIGHT][OMEGA_HASH_SIZE];
+
+  while (max_nonces > 0 && self->next_index < self->index_count) {
+    uint64_t index = self->next_index;
+    uint64_t left = self->index_count - index;
+    if (max_nonces < left)
+      left = max_nonces;
+    size_t in_flight = left < self->interleave ? (size_t)left
+                                               : self->interleave;
+    for (size_t l = 0; l < in_flight; ++l) {
+      nonces[l] = self->start_nonce + (index + l) * self->stride;
+    }
+    Proof__calculate_omega_full(omegas, nonces, in_flight, self->path_scratch,
+                                &self->config, self->challenge_id,
+                                self->memory, self->root_hash);
+
+    for (size_t l = 0; l < in_flight; ++l) {
+      size_t leading_zeros = Proof__leading_zeros(omegas[l], OMEGA_HASH_SIZE);
+      if (self->share && leading_zeros >= self->share_difficulty_bits) {
+        SearchShare share = {.nonce = nonces[l],
+                             .leading_zeros = leading_zeros,
+                             .omega = omegas[l]};
+        self->share(&share, self->share_user_data);
+      }
+      if (leading_zeros < self->config.difficulty_bits)
+        continue;
+
+      // Lanes past the winner are evaluated again by the next step
+      self->next_index = index + l + 1;
+      self->nonces_tried += l + 1;
+      Proof__drop(self->proof);
+      self->proof =
+          Proof__from_nonce(&self->config, self->challenge_id, self->memory,
+                            self->merkle_tree, nonces[l]);
+      return self->proof ? SearchStep__Found : SearchStep__Error;
+    }
+
+    self->next_index += in_flight;
+    self->nonces_tried += in_flight;
+    max_nonces -= in_flight;
+  }
+
+  return self->next_index < self->index_count ? SearchStep__Continue
+                                              : SearchStep__Exhausted;
+}
+
+Proof *SearchState__take_proof(SearchState *self) {
+  Proof *proof = self->proof;
+  self->proof = NULL;
+  return proof;
+}
+
+uint64_t SearchState__next_nonce(const SearchState *self) {
+  return self->start_nonce + self->next_index * self->stride;
+}
+
+uint64_t SearchState__nonces_tried(const SearchState *self) {
+  return self->nonces_tried;
+}
+
+void SearchState__drop(SearchState *self) {
+  if (!self)
+    return;
+  Proof__drop(self->proof);
+  free(self->path_scratch);
+  free(self);
+}
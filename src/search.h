@@ -0,0 +1,296 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct ThreadPool;
+
+/** Number of per-thread counters in SearchStats. */
+#define SEARCH_STATS_MAX_THREADS 64
+
+/**
+ * @brief Counters filled in while a search runs.
+ *
+ * Every field is atomic, so another thread may read the statistics while
+ * the search is still running.
+ */
+typedef struct SearchStats {
+  /** Nonces evaluated by all workers, including any past the winner. */
+  _Atomic uint64_t nonces_evaluated;
+  /** Memory elements read along Omega paths (search_length per nonce). */
+  _Atomic uint64_t element_reads;
+  /** Highest number of leading zero bits of any Omega seen so far. */
+  _Atomic size_t best_leading_zeros;
+  /** Number of workers of the search. */
+  _Atomic size_t thread_count;
+  /**
+   * Nonces evaluated by each worker. Workers beyond the last slot add to
+   * it.
+   */
+  _Atomic uint64_t thread_nonces[SEARCH_STATS_MAX_THREADS];
+  /** Monotonic timestamps in nanoseconds; finished_ns is 0 while running. */
+  _Atomic uint64_t started_ns;
+  _Atomic uint64_t finished_ns;
+  /** Nanoseconds from the start to the first valid nonce; 0 until then. */
+  _Atomic uint64_t solution_ns;
+  /** Nonces that met the share difficulty (0 unless shares are enabled). */
+  _Atomic uint64_t shares_found;
+} SearchStats;
+
+/**
+ * @brief Snapshot handed to the progress callback.
+ */
+typedef struct SearchProgress {
+  /** Nonces evaluated so far by all workers. */
+  uint64_t nonces_tried;
+  /**
+   * Frontier of the range: every nonce of the range before it has been
+   * evaluated, so a restarted search may begin here (see SearchCheckpoint).
+   */
+  uint64_t next_nonce;
+  /** Highest number of leading zero bits of any Omega seen so far. */
+  size_t best_leading_zeros;
+  /** Wall-clock seconds since the search started. */
+  double elapsed_seconds;
+} SearchProgress;
+
+/**
+ * @brief Progress callback. Calls never overlap, but they run on whichever
+ * worker thread crossed the reporting interval, so keep them short.
+ */
+typedef void (*SearchProgressCallback)(const SearchProgress *progress,
+                                       void *user_data);
+
+/**
+ * @brief A nonce whose Omega meets the share difficulty.
+ */
+typedef struct SearchShare {
+  uint64_t nonce;
+  /** Leading zero bits of the Omega hash; may also meet difficulty_bits. */
+  size_t leading_zeros;
+  /** The 64-byte Omega hash, valid only during the callback. */
+  const uint8_t *omega;
+} SearchShare;
+
+/**
+ * @brief Share callback. Like the progress callback, calls never overlap
+ * but run on the worker threads, so keep them short.
+ */
+typedef void (*SearchShareCallback)(const SearchShare *share, void *user_data);
+
+/**
+ * @brief Tunable parameters of the nonce search engine.
+ *
+ * Independent of the PoW Config: these settings change how fast a solution
+ * is found, never which proofs are valid.
+ */
+typedef struct SearchOptions {
+  /** Number of worker threads; 0 selects one per online CPU. */
+  size_t thread_count;
+
+  /** Number of consecutive nonces a worker claims at a time. */
+  size_t batch_size;
+
+  /**
+   * Nonces each worker keeps in flight (K), so that element loads of one
+   * nonce overlap with hashing of the others. 0 selects the default;
+   * values above OMEGA_MAX_IN_FLIGHT are clamped.
+   */
+  size_t interleave;
+
+  /**
+   * When true, the search returns the lowest valid nonce, which makes the
+   * result independent of thread scheduling. When false, the first valid
+   * nonce published by any worker wins and the others stop immediately.
+   */
+  bool lowest_nonce;
+
+  /**
+   * Optional cancellation flag. Setting it from any thread stops the search
+   * with SearchStatus__Cancelled. Each worker polls it between groups of
+   * nonces in flight, a group being at most min(interleave, batch_size)
+   * nonces, and the group already in flight is evaluated to the end. A
+   * flag raised once N nonces have been evaluated therefore stops the
+   * search with at most N + thread_count * min(interleave, batch_size)
+   * nonces evaluated. Every nonce up to and including the reported
+   * last_nonce was evaluated, and each other worker may have evaluated at
+   * most its in-flight group past it.
+   */
+  const atomic_bool *cancel_flag;
+
+  /**
+   * Wall-clock budget in seconds, measured from the start of the search;
+   * 0 disables it. Running out stops the search with
+   * SearchStatus__DeadlineExceeded.
+   */
+  double deadline_seconds;
+
+  /** Optional progress callback and its opaque argument. */
+  SearchProgressCallback progress;
+  void *progress_user_data;
+
+  /** Nonces between progress reports; 0 reports once per batch_size. */
+  uint64_t progress_interval;
+
+  /**
+   * Secondary, lower difficulty for proof-of-progress: every evaluated nonce
+   * whose Omega has at least this many leading zero bits is passed to
+   * `share` without stopping the search. 0 disables shares.
+   */
+  size_t share_difficulty_bits;
+
+  /** Share callback (required for shares) and its opaque argument. */
+  SearchShareCallback share;
+  void *share_user_data;
+
+  /** Optional statistics, reset when the search starts. */
+  SearchStats *stats;
+
+  /**
+   * Fraction of wall-clock time each worker spends searching. Workers rest
+   * after every few milliseconds of work to keep to it, so a throttled
+   * search spreads its CPU use evenly instead of running into a cgroup
+   * quota. 0 and values of 1 or more disable throttling.
+   */
+  double duty_cycle;
+} SearchOptions;
+
+/**
+ * @brief Outcome of a bounded search.
+ */
+typedef enum SearchStatus {
+  /** A valid nonce was found; the result carries its proof. */
+  SearchStatus__Found = 0,
+  /** Every nonce of the range was evaluated without success. */
+  SearchStatus__NotFoundInRange,
+  /** The cancellation flag was raised before a nonce was found. */
+  SearchStatus__Cancelled,
+  /** The deadline passed before a nonce was found. */
+  SearchStatus__DeadlineExceeded,
+  /** The search could not run (allocation failure or missing Merkle root). */
+  SearchStatus__Error,
+} SearchStatus;
+
+/**
+ * @brief Outcome of one Proof__search_step.
+ */
+typedef enum SearchStep {
+  /** The step budget ran out; call again to go on. */
+  SearchStep__Continue = 0,
+  /** A valid nonce was found; take its proof from the state. */
+  SearchStep__Found,
+  /** Every nonce of the range has been evaluated. */
+  SearchStep__Exhausted,
+  /** The proof of a valid nonce could not be built. */
+  SearchStep__Error,
+} SearchStep;
+
+/**
+ * @brief Result of a bounded search.
+ */
+typedef struct SearchResult {
+  SearchStatus status;
+
+  /** The winning proof when status is Found (owned by the caller). */
+  struct Proof *proof;
+
+  /**
+   * Last nonce of the range known to be evaluated: the winner when Found,
+   * the final nonce of the range when NotFoundInRange, and the end of the
+   * fully evaluated prefix when the search was interrupted. In lowest_nonce
+   * mode every nonce of the range up to and including it was evaluated, so
+   * a search resumes at last_nonce + stride (if nothing was evaluated this
+   * is start - stride, in unsigned arithmetic).
+   */
+  uint64_t last_nonce;
+
+  /** Nonces evaluated by all workers, including any past the winner. */
+  uint64_t nonces_tried;
+} SearchResult;
+
+/**
+ * @brief Resources reused across searches: the worker threads and each
+ * worker's Omega scratch buffer, grown on demand.
+ */
+typedef struct SearchWorkspace {
+  struct ThreadPool *pool;
+  /** Per-worker scratch capacity in 64-byte hashes. */
+  size_t scratch_hashes;
+  /** thread_count * scratch_hashes hashes. */
+  uint8_t *scratch;
+  /** Per-worker lower bound of the next position to evaluate. */
+  _Atomic uint64_t *positions;
+} SearchWorkspace;
+
+/**
+ * @brief Creates a workspace with `thread_count` workers (0 selects one per
+ * online CPU).
+ * @return The workspace, or NULL on failure.
+ */
+SearchWorkspace *SearchWorkspace__new(size_t thread_count);
+
+/**
+ * @brief Returns the number of workers of the workspace.
+ */
+size_t SearchWorkspace__thread_count(const SearchWorkspace *self);
+
+/**
+ * @brief Joins the workers and frees the workspace. Safe to call with NULL.
+ */
+void SearchWorkspace__drop(SearchWorkspace *self);
+
+/**
+ * @brief Returns the default search options: one thread per online CPU,
+ * batches of 256 nonces, 16 nonces in flight per worker and deterministic
+ * (lowest nonce) results.
+ */
+SearchOptions SearchOptions__default();
+
+/**
+ * @brief Resolves thread_count == 0 to the CPU budget of the process: the
+ * CPUs it may run on, capped by its cgroup v2 quota (rounded up).
+ */
+size_t SearchOptions__effective_thread_count(const SearchOptions *self);
+
+/**
+ * @brief Throttles the search to `cpu_share` (0 to 1) of the CPU budget of
+ * the process.
+ *
+ * Sets thread_count to the budget share rounded up and duty_cycle to the
+ * fraction of it each of those workers may use, e.g. a 2.5 CPU quota at
+ * share 0.5 gives 2 workers at a duty cycle of 0.625.
+ */
+void SearchOptions__fit_cpu_quota(SearchOptions *self, double cpu_share);
+
+/**
+ * @brief Clears all counters.
+ */
+void SearchStats__reset(SearchStats *self);
+
+/**
+ * @brief Wall-clock seconds since the search started, up to now while it
+ * runs and up to its end afterwards.
+ */
+double SearchStats__elapsed_seconds(const SearchStats *self);
+
+/**
+ * @brief Wall-clock hashrate of all workers in nonces per second.
+ */
+double SearchStats__hashrate(const SearchStats *self);
+
+/**
+ * @brief Seconds from the start to the first valid nonce, or a negative
+ * value if none has been found.
+ */
+double SearchStats__time_to_solution(const SearchStats *self);
+
+/**
+ * @brief Prints a human-readable summary of the statistics.
+ */
+void SearchStats__print(const SearchStats *self, FILE *out);
+
+#endif // SEARCH_H
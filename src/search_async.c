@@ -0,0 +1,172 @@
+#define _POSIX_C_SOURCE 200809L // clock_gettime
+
+#include "search_async.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct SearchHandle {
+  SearchWorkspace *workspace;
+  SearchWorkspace *owned_workspace; // NULL when borrowed
+
+  Config config;
+  const ChallengeId *challenge_id;
+  const Memory *memory;
+  const MerkleTree *merkle_tree;
+  uint64_t start;
+  uint64_t end;
+  uint64_t stride;
+  SearchOptions options;
+  atomic_bool cancel;
+
+  pthread_t thread;
+  bool joined;
+  pthread_mutex_t lock;
+  pthread_cond_t finished_cond;
+  bool finished; // Protected by `lock`
+  SearchResult result;
+};
+
+static void *SearchHandle__thread_main(void *arg) {
+  SearchHandle *self = (SearchHandle *)arg;
+  SearchResult result = Proof__search_range_in(
+      self->workspace, self->config, self->challenge_id, self->memory,
+      self->merkle_tree, self->start, self->end, self->stride, &self->options);
+
+  pthread_mutex_lock(&self->lock);
+  self->result = result;
+  self->finished = true;
+  pthread_cond_broadcast(&self->finished_cond);
+  pthread_mutex_unlock(&self->lock);
+  return NULL;
+}
+
+static SearchHandle *SearchHandle__start(SearchWorkspace *workspace,
+                                         SearchWorkspace *owned_workspace,
+                                         Config config,
+                                         const ChallengeId *challenge_id,
+                                         const Memory *memory,
+                                         const MerkleTree *merkle_tree,
+                                         uint64_t start, uint64_t end,
+                                         uint64_t stride,
+                                         const SearchOptions *options) {
+  SearchHandle *self = (SearchHandle *)calloc(1, sizeof(SearchHandle));
+  if (!self)
+    return NULL;
+
+  self->workspace = workspace;
+  self->owned_workspace = owned_workspace;
+  self->config = config;
+  self->challenge_id = challenge_id;
+  self->memory = memory;
+  self->merkle_tree = merkle_tree;
+  self->start = start;
+  self->end = end;
+  self->stride = stride;
+  self->options = options ? *options : SearchOptions__default();
+  atomic_init(&self->cancel, false);
+  self->options.cancel_flag = &self->cancel;
+  pthread_mutex_init(&self->lock, NULL);
+  pthread_cond_init(&self->finished_cond, NULL);
+
+  if (pthread_create(&self->thread, NULL, SearchHandle__thread_main, self) !=
+      0) {
+    pthread_cond_destroy(&self->finished_cond);
+    pthread_mutex_destroy(&self->lock);
+    free(self);
+    return NULL;
+  }
+  return self;
+}
+
+SearchHandle *Proof__search_async(Config config,
+                                  const ChallengeId *challenge_id,
+                                  const Memory *memory,
+                                  const MerkleTree *merkle_tree,
+                                  uint64_t start, uint64_t end, uint64_t stride,
+                                  const SearchOptions *options) {
+  SearchOptions defaults = SearchOptions__default();
+  SearchWorkspace *workspace = SearchWorkspace__new(
+      SearchOptions__effective_thread_count(options ? options : &defaults));
+  if (!workspace)
+    return NULL;
+
+  SearchHandle *self =
+      SearchHandle__start(workspace, workspace, config, challenge_id, memory,
+                          merkle_tree, start, end, stride, options);
+  if (!self)
+    SearchWorkspace__drop(workspace);
+  return self;
+}
+
+SearchHandle *Proof__search_async_in(SearchWorkspace *workspace, Config config,
+                                     const ChallengeId *challenge_id,
+                                     const Memory *memory,
+                                     const MerkleTree *merkle_tree,
+                                     uint64_t start, uint64_t end,
+                                     uint64_t stride,
+                                     const SearchOptions *options) {
+  return SearchHandle__start(workspace, NULL, config, challenge_id, memory,
+                             merkle_tree, start, end, stride, options);
+}
+
+bool SearchHandle__poll(SearchHandle *self) {
+  pthread_mutex_lock(&self->lock);
+  bool finished = self->finished;
+  pthread_mutex_unlock(&self->lock);
+  return finished;
+}
+
+bool SearchHandle__wait_timeout(SearchHandle *self, double seconds) {
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  if (seconds > 0) {
+    time_t whole = (time_t)seconds;
+    long nanos = deadline.tv_nsec + (long)((seconds - (double)whole) * 1e9);
+    deadline.tv_sec += whole + nanos / 1000000000L;
+    deadline.tv_nsec = nanos % 1000000000L;
+  }
+
+  pthread_mutex_lock(&self->lock);
+  while (!self->finished &&
+         pthread_cond_timedwait(&self->finished_cond, &self->lock,
+                                &deadline) == 0) {
+  }
+  bool finished = self->finished;
+  pthread_mutex_unlock(&self->lock);
+  return finished;
+}
+
+void SearchHandle__cancel(SearchHandle *self) {
+  atomic_store(&self->cancel, true);
+}
+
+/**
+ * @brief Waits for the coordinator thread to exit (once).
+ */
+static void SearchHandle__join(SearchHandle *self) {
+  if (self->joined)
+    return;
+  pthread_join(self->thread, NULL);
+  self->joined = true;
+}
+
+SearchResult SearchHandle__take_result(SearchHandle *self) {
+  SearchHandle__join(self);
+  SearchResult result = self->result;
+  self->result.proof = NULL;
+  return result;
+}
+
+void SearchHandle__drop(SearchHandle *self) {
+  if (!self)
+    return;
+  SearchHandle__cancel(self);
+  SearchHandle__join(self);
+  Proof__drop(self->result.proof);
+  pthread_cond_destroy(&self->finished_cond);
+  pthread_mutex_destroy(&self->lock);
+  SearchWorkspace__drop(self->owned_workspace);
+  free(self);
+}
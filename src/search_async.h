@@ -0,0 +1,74 @@
+#ifndef SEARCH_ASYNC_H
+#define SEARCH_ASYNC_H
+
+#include "proof.h"
+#include "search.h"
+#include <stdbool.h>
+
+/**
+ * @brief A search running in the background.
+ *
+ * The search runs on a coordinator thread that acts as worker 0 of the
+ * workspace, so the thread that started it never blocks unless it asks to.
+ */
+typedef struct SearchHandle SearchHandle;
+
+/**
+ * @brief Starts Proof__search_range in the background and returns at once.
+ *
+ * The handle's own cancellation flag replaces options->cancel_flag; the
+ * other options apply as usual, with callbacks running on the search
+ * threads. challenge_id, memory and merkle_tree must stay alive and
+ * unmodified until the search is finished.
+ * @return The handle, or NULL if the threads could not be started.
+ */
+SearchHandle *Proof__search_async(Config config,
+                                  const ChallengeId *challenge_id,
+                                  const Memory *memory,
+                                  const MerkleTree *merkle_tree,
+                                  uint64_t start, uint64_t end, uint64_t stride,
+                                  const SearchOptions *options);
+
+/**
+ * @brief Proof__search_async on the threads of `workspace`, which must not
+ * be used for anything else until the search is finished.
+ */
+SearchHandle *Proof__search_async_in(SearchWorkspace *workspace, Config config,
+                                     const ChallengeId *challenge_id,
+                                     const Memory *memory,
+                                     const MerkleTree *merkle_tree,
+                                     uint64_t start, uint64_t end,
+                                     uint64_t stride,
+                                     const SearchOptions *options);
+
+/**
+ * @brief Returns true once the search is finished. Never blocks.
+ */
+bool SearchHandle__poll(SearchHandle *self);
+
+/**
+ * @brief Waits up to `seconds` for the search to finish.
+ * @return true if it is finished.
+ */
+bool SearchHandle__wait_timeout(SearchHandle *self, double seconds);
+
+/**
+ * @brief Asks the search to stop; it finishes with SearchStatus__Cancelled
+ * unless a result was already reached. Never blocks.
+ */
+void SearchHandle__cancel(SearchHandle *self);
+
+/**
+ * @brief Waits for the search to finish and hands over its result; the
+ * caller owns result.proof. Later calls return the same result without the
+ * proof.
+ */
+SearchResult SearchHandle__take_result(SearchHandle *self);
+
+/**
+ * @brief Cancels the search if it is still running, waits for it and frees
+ * the handle together with any untaken proof. Safe to call with NULL.
+ */
+void SearchHandle__drop(SearchHandle *self);
+
+#endif // SEARCH_ASYNC_H
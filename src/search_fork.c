@@ -0,0 +1,288 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+#define _POSIX_C_SOURCE 200809L // clock_gettime, nanosleep
+
+#include "search_fork.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define NO_NONCE UINT64_MAX
+#define NO_BLOCK UINT64_MAX
+#define BLOCK_BATCHES 16      // Nonces per block, in batches
+#define RESTARTS_PER_PROCESS 4 // Replacement budget per worker
+#define POLL_INTERVAL_NS 1000000L
+
+/**
+ * @brief State shared by the parent and its workers, in an anonymous
+ * shared mapping. Slot i holds the block worker i is working on (a lower
+ * bound while it claims the next one); a worker that stops early leaves
+ * its unfinished block there.
+ */
+typedef struct ForkShared {
+  _Atomic uint64_t next_block;
+  _Atomic uint64_t found_nonce; // NO_NONCE while nothing has been found
+  _Atomic uint64_t nonces_tried;
+  atomic_bool stop;
+  _Atomic uint64_t slots[];
+} ForkShared;
+
+/**
+ * @brief Parameters of one search, identical in every worker.
+ */
+typedef struct ForkSearch {
+  Config config;
+  const ChallengeId *challenge_id;
+  const Memory *memory;
+  const MerkleTree *merkle_tree;
+  uint64_t start;
+  uint64_t end;
+  uint64_t stride;
+  uint64_t block_size; // Nonces per block
+  uint64_t block_count;
+  SearchOptions options;
+  ForkShared *shared;
+} ForkSearch;
+
+static double fork_monotonic_seconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void fork_store_min(_Atomic uint64_t *target, uint64_t value) {
+  uint64_t current = atomic_load(target);
+  while (value < current &&
+         !atomic_compare_exchange_weak(target, &current, value)) {
+  }
+}
+
+/**
+ * @brief Body of a worker process: searches blocks until none is left or
+ * the search stops. With `redo`, first searches the block left in its slot
+ * by the worker it replaces. Exits with EXIT_SUCCESS only when it ran out
+ * of useful blocks or saw the stop word; any other failure leaves the
+ * block in the slot and exits with EXIT_FAILURE, so that it is redone.
+ */
+static void ForkSearch__worker(const ForkSearch *self, size_t slot,
+                               bool redo) {
+  ForkShared *shared = self->shared;
+  SearchWorkspace *workspace = SearchWorkspace__new(
+      SearchOptions__effective_thread_count(&self->options));
+  if (!workspace)
+    _exit(EXIT_FAILURE);
+
+  int exit_status = EXIT_SUCCESS;
+  for (;;) {
+    uint64_t block;
+    if (redo) {
+      block = atomic_load(&shared->slots[slot]);
+      redo = false;
+    } else {
+      atomic_store(&shared->slots[slot], atomic_load(&shared->next_block));
+      block = atomic_fetch_add(&shared->next_block, 1);
+      atomic_store(&shared->slots[slot], block);
+    }
+    if (block >= self->block_count || atomic_load(&shared->stop))
+      break;
+
+    uint64_t first = self->start + block * self->block_size * self->stride;
+    if (self->options.lowest_nonce &&
+        first > atomic_load(&shared->found_nonce))
+      break; // Every later block only holds higher nonces
+
+    uint64_t end = block + 1 < self->block_count
+                       ? first + self->block_size * self->stride
+                       : self->end;
+    SearchResult result = Proof__search_range_in(
+        workspace, self->config, self->challenge_id, self->memory,
+        self->merkle_tree, first, end, self->stride, &self->options);
+    atomic_fetch_add(&shared->nonces_tried, result.nonces_tried);
+
+    if (result.status == SearchStatus__Found) {
+      fork_store_min(&shared->found_nonce, result.last_nonce);
+      Proof__drop(result.proof);
+      if (!self->options.lowest_nonce)
+        atomic_store(&shared->stop, true);
+    } else if (result.status != SearchStatus__NotFoundInRange) {
+      // Stopped or failed: the block stays in the slot
+      if (!atomic_load(&shared->stop))
+        exit_status = EXIT_FAILURE;
+      break;
+    }
+  }
+
+  SearchWorkspace__drop(workspace);
+  _exit(exit_status);
+}
+
+static pid_t ForkSearch__spawn(const ForkSearch *self, size_t slot,
+                               bool redo) {
+  pid_t pid = fork();
+  if (pid == 0)
+    ForkSearch__worker(self, slot, redo);
+  return pid;
+}
+
+SearchResult Proof__search_forked(Config config,
+                                  const ChallengeId *challenge_id,
+                                  const Memory *memory,
+                                  const MerkleTree *merkle_tree,
+                                  uint64_t start, uint64_t end, uint64_t stride,
+                                  size_t process_count,
+                                  const SearchOptions *options) {
+  SearchResult result = {
+      .status = SearchStatus__Error, .proof = NULL, .last_nonce = start};
+  if (stride == 0)
+    stride = 1;
+  if (process_count == 0)
+    process_count = 1;
+
+  ForkSearch search = {
+      .config = config,
+      .challenge_id = challenge_id,
+      .memory = memory,
+      .merkle_tree = merkle_tree,
+      .start = start,
+      .end = end,
+      .stride = stride,
+      .options = options ? *options : SearchOptions__default(),
+  };
+  uint64_t index_count = end > start ? (end - start - 1) / stride + 1 : 0;
+  size_t batch_size =
+      search.options.batch_size > 0 ? search.options.batch_size : 256;
+  search.block_size = (uint64_t)batch_size * BLOCK_BATCHES;
+  search.block_count = index_count / search.block_size +
+                       (index_count % search.block_size != 0);
+
+  // The parent watches cancellation and the deadline for all workers
+  const atomic_bool *cancel_flag = search.options.cancel_flag;
+  double deadline_at =
+      search.options.deadline_seconds > 0
+          ? fork_monotonic_seconds() + search.options.deadline_seconds
+          : 0;
+  search.options.deadline_seconds = 0;
+  search.options.stats = NULL;
+
+  size_t shared_size =
+      sizeof(ForkShared) + process_count * sizeof(_Atomic uint64_t);
+  ForkShared *shared =
+      (ForkShared *)mmap(NULL, shared_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  pid_t *pids = (pid_t *)calloc(process_count, sizeof(pid_t));
+  if (shared == MAP_FAILED || !pids) {
+    if (shared != MAP_FAILED)
+      munmap(shared, shared_size);
+    free(pids);
+    return result;
+  }
+  atomic_init(&shared->next_block, 0);
+  atomic_init(&shared->found_nonce, NO_NONCE);
+  atomic_init(&shared->nonces_tried, 0);
+  atomic_init(&shared->stop, false);
+  for (size_t i = 0; i < process_count; ++i) {
+    atomic_init(&shared->slots[i], 0);
+  }
+  search.shared = shared;
+  search.options.cancel_flag = &shared->stop;
+
+  // A worker that cannot be started is replaced like a lost one. It has
+  // not claimed a block, so its slot must not hold back the frontier
+  size_t restarts = process_count * RESTARTS_PER_PROCESS;
+  size_t live = 0;
+  for (size_t i = 0; i < process_count; ++i) {
+    pids[i] = ForkSearch__spawn(&search, i, false);
+    while (pids[i] <= 0 && restarts > 0) {
+      --restarts;
+      pids[i] = ForkSearch__spawn(&search, i, false);
+    }
+    if (pids[i] > 0)
+      ++live;
+    else
+      atomic_store(&shared->slots[i], NO_BLOCK);
+  }
+  if (live == 0) {
+    munmap(shared, shared_size);
+    free(pids);
+    return result;
+  }
+
+  SearchStatus halt = SearchStatus__NotFoundInRange;
+  while (live > 0) {
+    if (halt == SearchStatus__NotFoundInRange) {
+      if (cancel_flag && atomic_load(cancel_flag))
+        halt = SearchStatus__Cancelled;
+      else if (deadline_at > 0 && fork_monotonic_seconds() >= deadline_at)
+        halt = SearchStatus__DeadlineExceeded;
+      if (halt != SearchStatus__NotFoundInRange)
+        atomic_store(&shared->stop, true);
+    }
+
+    bool reaped = false;
+    for (size_t i = 0; i < process_count; ++i) {
+      int status;
+      if (pids[i] <= 0 || waitpid(pids[i], &status, WNOHANG) != pids[i])
+        continue;
+      reaped = true;
+      pids[i] = 0;
+      if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) {
+        --live;
+        continue;
+      }
+
+      // Crashed: a replacement picks up the unfinished block
+      if (!atomic_load(&shared->stop) && restarts > 0) {
+        --restarts;
+        pids[i] = ForkSearch__spawn(&search, i, true);
+      }
+      if (pids[i] <= 0)
+        --live; // Its block stays in the slot and holds back the frontier
+    }
+    if (!reaped) {
+      struct timespec pause = {.tv_sec = 0, .tv_nsec = POLL_INTERVAL_NS};
+      nanosleep(&pause, NULL);
+    }
+  }
+
+  // Every block below the lowest one left in a slot has been searched
+  uint64_t frontier = atomic_load(&shared->next_block);
+  for (size_t i = 0; i < process_count; ++i) {
+    uint64_t block = atomic_load(&shared->slots[i]);
+    if (block < frontier)
+      frontier = block;
+  }
+  if (frontier > search.block_count)
+    frontier = search.block_count;
+  uint64_t searched = frontier * search.block_size;
+  if (searched > index_count)
+    searched = index_count;
+
+  uint64_t found = atomic_load(&shared->found_nonce);
+  result.nonces_tried = atomic_load(&shared->nonces_tried);
+  munmap(shared, shared_size);
+  free(pids);
+
+  // A block lost below the winner's may hold a lower winning nonce
+  uint64_t found_block = (found - start) / stride / search.block_size;
+  if (found != NO_NONCE &&
+      !(search.options.lowest_nonce && frontier < found_block)) {
+    result.last_nonce = found;
+    result.proof =
+        Proof__from_nonce(&config, challenge_id, memory, merkle_tree, found);
+    result.status = result.proof ? SearchStatus__Found : SearchStatus__Error;
+    return result;
+  }
+
+  // Without an interruption, a block left unsearched means workers kept
+  // failing on it
+  result.last_nonce = start + searched * stride - stride;
+  bool complete = frontier >= search.block_count;
+  result.status = halt == SearchStatus__NotFoundInRange && !complete
+                      ? SearchStatus__Error
+                      : halt;
+  return result;
+}
@@ -0,0 +1,37 @@
+#ifndef SEARCH_FORK_H
+#define SEARCH_FORK_H
+
+#include "proof.h"
+#include "search.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Proof__search_range spread over `process_count` forked worker
+ * processes, for fault isolation.
+ *
+ * The workers inherit memory and merkle_tree from the fork and only read
+ * them, so the pages stay shared. They claim blocks of nonces from a
+ * counter in a shared anonymous mapping and watch a shared stop word; each
+ * runs the threaded engine with options->thread_count threads on its
+ * blocks. The parent builds the winning Proof from the nonce.
+ *
+ * A worker that crashes is replaced, and its replacement first redoes the
+ * block that was in progress, so a crash loses neither coverage nor the
+ * lowest-nonce guarantee. Progress and share callbacks run inside the
+ * workers; options->stats is not filled in. Cancellation and the deadline
+ * are watched by the parent.
+ *
+ * @return As Proof__search_range. After an interruption last_nonce ends the
+ * prefix of fully searched blocks. Error if no worker could be started, or
+ * if workers kept failing on a block the result depends on.
+ */
+SearchResult Proof__search_forked(Config config,
+                                  const ChallengeId *challenge_id,
+                                  const Memory *memory,
+                                  const MerkleTree *merkle_tree,
+                                  uint64_t start, uint64_t end, uint64_t stride,
+                                  size_t process_count,
+                                  const SearchOptions *options);
+
+#endif // SEARCH_FORK_H
@@ -0,0 +1,199 @@
+#include "solver.h"
+#include "proof.h"
+#include "thread_pool.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Shared state of a parallel build pass: workers claim items from
+ * `next` until `count` is reached.
+ */
+typedef struct SolverBuild {
+  ItsukuSolver *solver;
+  size_t count;
+  _Atomic size_t next;
+} SolverBuild;
+
+static void SolverBuild__chunks(void *arg, size_t worker_id) {
+  (void)worker_id;
+  SolverBuild *self = (SolverBuild *)arg;
+  Memory *memory = self->solver->memory;
+
+  for (size_t i = atomic_fetch_add(&self->next, 1); i < self->count;
+       i = atomic_fetch_add(&self->next, 1)) {
+    Memory__build_chunk(&memory->config, i, memory->chunks[i],
+                        self->solver->challenge_id);
+  }
+}
+
+static void SolverBuild__leaves(void *arg, size_t worker_id) {
+  (void)worker_id;
+  SolverBuild *self = (SolverBuild *)arg;
+  ItsukuSolver *solver = self->solver;
+
+  // Leaves are claimed a chunk at a time so neighbours share cache lines
+  size_t step = solver->config.chunk_size;
+  for (size_t begin = atomic_fetch_add(&self->next, step); begin < self->count;
+       begin = atomic_fetch_add(&self->next, step)) {
+    MerkleTree__compute_leaf_range(solver->merkle_tree, solver->challenge_id,
+                                   solver->memory, begin, begin + step);
+  }
+}
+
+static bool ItsukuSolver__has_challenge(const ItsukuSolver *self,
+                                        const ChallengeId *challenge_id) {
+  return self->challenge_id &&
+         self->challenge_id->bytes_len == challenge_id->bytes_len &&
+         memcmp(self->challenge_id->bytes, challenge_id->bytes,
+                challenge_id->bytes_len) == 0;
+}
+
+ItsukuSolver *ItsukuSolver__new(Config config, const SearchOptions *options) {
+  ItsukuSolver *self = (ItsukuSolver *)calloc(1, sizeof(ItsukuSolver));
+  if (!self)
+    return NULL;
+
+  self->config = config;
+  self->options = options ? *options : SearchOptions__default();
+  self->workspace = SearchWorkspace__new(
+      SearchOptions__effective_thread_count(&self->options));
+  self->memory = Memory__new(config);
+  if (!self->workspace || !self->memory) {
+    ItsukuSolver__drop(self);
+    return NULL;
+  }
+  return self;
+}
+
+/**
+ * @brief Hashes the current memory into the Merkle tree, on the pool.
+ */
+static void ItsukuSolver__build_tree(ItsukuSolver *self) {
+  SolverBuild build = {
+      .solver = self,
+      .count = self->config.chunk_count * self->config.chunk_size};
+  atomic_init(&build.next, 0);
+  ThreadPool__run(self->workspace->pool, SolverBuild__leaves, &build);
+  MerkleTree__compute_intermediate_nodes(self->merkle_tree,
+                                         self->challenge_id);
+}
+
+/**
+ * @brief Returns true if the tree has the node size `difficulty_bits` needs.
+ */
+static bool ItsukuSolver__has_tree_for(const ItsukuSolver *self,
+                                       size_t difficulty_bits) {
+  Config config = self->config;
+  config.difficulty_bits = difficulty_bits;
+  return self->merkle_tree &&
+         self->merkle_tree->node_size ==
+             MerkleTree__calculate_node_size(&config);
+}
+
+bool ItsukuSolver__is_prepared(const ItsukuSolver *self,
+                               const ChallengeId *challenge_id,
+                               size_t difficulty_bits) {
+  return ItsukuSolver__has_challenge(self, challenge_id) &&
+         ItsukuSolver__has_tree_for(self, difficulty_bits);
+}
+
+void ItsukuSolver__swap_prepared(ItsukuSolver *a, ItsukuSolver *b) {
+  Memory *memory = a->memory;
+  a->memory = b->memory;
+  b->memory = memory;
+
+  MerkleTree *merkle_tree = a->merkle_tree;
+  a->merkle_tree = b->merkle_tree;
+  b->merkle_tree = merkle_tree;
+
+  ChallengeId *challenge_id = a->challenge_id;
+  a->challenge_id = b->challenge_id;
+  b->challenge_id = challenge_id;
+}
+
+bool ItsukuSolver__prepare(ItsukuSolver *self, const ChallengeId *challenge_id,
+                           size_t difficulty_bits) {
+  Config config = self->config;
+  config.difficulty_bits = difficulty_bits;
+
+  bool same_challenge = ItsukuSolver__has_challenge(self, challenge_id);
+  bool same_tree = ItsukuSolver__has_tree_for(self, difficulty_bits);
+  if (same_challenge && same_tree)
+    return true;
+
+  if (!same_challenge) {
+    ChallengeId *copy =
+        ChallengeId__new(challenge_id->bytes, challenge_id->bytes_len);
+    if (!copy)
+      return false;
+    ChallengeId__drop(self->challenge_id);
+    self->challenge_id = copy;
+
+    SolverBuild build = {.solver = self, .count = self->config.chunk_count};
+    atomic_init(&build.next, 0);
+    ThreadPool__run(self->workspace->pool, SolverBuild__chunks, &build);
+  }
+
+  // The node size grows with the difficulty, so a tree is only reusable
+  // across difficulties that round to the same number of bytes
+  if (!same_tree) {
+    MerkleTree__drop(self->merkle_tree);
+    self->merkle_tree = MerkleTree__new(config);
+    if (!self->merkle_tree)
+      return false;
+  }
+
+  ItsukuSolver__build_tree(self);
+  return true;
+}
+
+SearchResult ItsukuSolver__solve(ItsukuSolver *self,
+                                 const ChallengeId *challenge_id,
+                                 size_t difficulty_bits) {
+  return ItsukuSolver__solve_range(self, challenge_id, difficulty_bits, 1,
+                                   UINT64_MAX, 1);
+}
+
+SearchResult ItsukuSolver__solve_range(ItsukuSolver *self,
+                                       const ChallengeId *challenge_id,
+                                       size_t difficulty_bits, uint64_t start,
+                                       uint64_t end, uint64_t stride) {
+  if (!ItsukuSolver__prepare(self, challenge_id, difficulty_bits)) {
+    return (SearchResult){.status = SearchStatus__Error, .last_nonce = start};
+  }
+
+  Config config = self->config;
+  config.difficulty_bits = difficulty_bits;
+  return Proof__search_range_in(self->workspace, config, challenge_id,
+                                self->memory, self->merkle_tree, start, end,
+                                stride, &self->options);
+}
+
+SearchResult ItsukuSolver__solve_many(ItsukuSolver *self,
+                                      const ChallengeId *challenge_id,
+                                      size_t difficulty_bits,
+                                      size_t max_solutions, Proof **proofs_out,
+                                      size_t *solution_count) {
+  *solution_count = 0;
+  if (!ItsukuSolver__prepare(self, challenge_id, difficulty_bits)) {
+    return (SearchResult){.status = SearchStatus__Error};
+  }
+
+  Config config = self->config;
+  config.difficulty_bits = difficulty_bits;
+  return Proof__search_many_in(self->workspace, config, challenge_id,
+                               self->memory, self->merkle_tree, 1, UINT64_MAX,
+                               1, max_solutions, &self->options, proofs_out,
+                               solution_count);
+}
+
+void ItsukuSolver__drop(ItsukuSolver *self) {
+  if (!self)
+    return;
+  SearchWorkspace__drop(self->workspace);
+  MerkleTree__drop(self->merkle_tree);
+  Memory__drop(self->memory);
+  ChallengeId__drop(self->challenge_id);
+  free(self);
+}
@@ -0,0 +1,97 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "challenge_id.h"
+#include "config.h"
+#include "memory.h"
+#include "merkle_tree.h"
+#include "search.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Long-lived prover that owns everything a proof needs.
+ *
+ * Memory, Merkle tree, worker threads and search scratch buffers are
+ * allocated once and reused by every solve. The memory is rebuilt only when
+ * the challenge changes. The tree is rehashed when the challenge changes
+ * and reallocated only when a new difficulty changes its node size, so
+ * re-solving the same challenge at a nearby difficulty only runs the
+ * search.
+ */
+typedef struct ItsukuSolver {
+  Config config;
+  SearchOptions options;
+  SearchWorkspace *workspace;
+  Memory *memory;
+  /** Built for the node size of the last difficulty; NULL before. */
+  MerkleTree *merkle_tree;
+  /** The challenge the memory and tree are built for (owned copy). */
+  ChallengeId *challenge_id;
+} ItsukuSolver;
+
+/**
+ * @brief Allocates a solver for `config`. The thread count of `options`
+ * (NULL selects SearchOptions__default()) sizes the worker pool.
+ * @return The solver, or NULL on allocation failure.
+ */
+ItsukuSolver *ItsukuSolver__new(Config config, const SearchOptions *options);
+
+/**
+ * @brief Brings memory and tree up to date for `challenge_id` at
+ * `difficulty_bits`, doing only the work that changed.
+ * @return false on allocation failure.
+ */
+bool ItsukuSolver__prepare(ItsukuSolver *self, const ChallengeId *challenge_id,
+                           size_t difficulty_bits);
+
+/**
+ * @brief Finds a proof for `challenge_id` at `difficulty_bits`.
+ *
+ * The proof borrows `challenge_id` (not the solver's copy), so the caller
+ * keeps it alive for as long as the proof.
+ */
+SearchResult ItsukuSolver__solve(ItsukuSolver *self,
+                                 const ChallengeId *challenge_id,
+                                 size_t difficulty_bits);
+
+/**
+ * @brief ItsukuSolver__solve over the nonces start, start + stride, ...
+ * below end (see Proof__search_range), e.g. to resume from a checkpoint.
+ */
+SearchResult ItsukuSolver__solve_range(ItsukuSolver *self,
+                                       const ChallengeId *challenge_id,
+                                       size_t difficulty_bits, uint64_t start,
+                                       uint64_t end, uint64_t stride);
+
+/**
+ * @brief Collects up to `max_solutions` proofs for `challenge_id` at
+ * `difficulty_bits` in one sweep (see Proof__search_many).
+ */
+SearchResult ItsukuSolver__solve_many(ItsukuSolver *self,
+                                      const ChallengeId *challenge_id,
+                                      size_t difficulty_bits,
+                                      size_t max_solutions,
+                                      struct Proof **proofs_out,
+                                      size_t *solution_count);
+
+/**
+ * @brief Returns true if memory and tree are built for `challenge_id` at
+ * `difficulty_bits`, so solving it only runs the search.
+ */
+bool ItsukuSolver__is_prepared(const ItsukuSolver *self,
+                               const ChallengeId *challenge_id,
+                               size_t difficulty_bits);
+
+/**
+ * @brief Exchanges the memory, tree and challenge of two solvers of the same
+ * Config, leaving their threads and options in place.
+ */
+void ItsukuSolver__swap_prepared(ItsukuSolver *a, ItsukuSolver *b);
+
+/**
+ * @brief Frees the solver and everything it owns. Safe to call with NULL.
+ */
+void ItsukuSolver__drop(ItsukuSolver *self);
+
+#endif // SOLVER_H
@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200809L // sysconf
+
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct ThreadPool {
+  size_t thread_count;
+  pthread_t *threads; // thread_count - 1 threads
+  size_t started;     // Threads actually created
+
+  pthread_mutex_t lock;
+  pthread_cond_t work_ready;
+  pthread_cond_t work_done;
+
+  // Protected by `lock`
+  ThreadPoolTask task;
+  void *arg;
+  unsigned long generation; // Bumped for every ThreadPool__run
+  size_t pending;           // Threads still running the current task
+  bool stopping;
+};
+
+/**
+ * @brief Argument of one pool thread.
+ */
+typedef struct ThreadPoolSlot {
+  ThreadPool *pool;
+  size_t worker_id;
+} ThreadPoolSlot;
+
+static void *ThreadPool__thread_main(void *arg) {
+  ThreadPoolSlot slot = *(ThreadPoolSlot *)arg;
+  free(arg);
+  ThreadPool *self = slot.pool;
+  unsigned long seen = 0;
+
+  pthread_mutex_lock(&self->lock);
+  for (;;) {
+    while (!self->stopping && self->generation == seen)
+      pthread_cond_wait(&self->work_ready, &self->lock);
+    if (self->stopping)
+      break;
+
+    seen = self->generation;
+    ThreadPoolTask task = self->task;
+    void *task_arg = self->arg;
+    pthread_mutex_unlock(&self->lock);
+
+    task(task_arg, slot.worker_id);
+
+    pthread_mutex_lock(&self->lock);
+    if (--self->pending == 0)
+      pthread_cond_signal(&self->work_done);
+  }
+  pthread_mutex_unlock(&self->lock);
+  return NULL;
+}
+
+ThreadPool *ThreadPool__new(size_t thread_count) {
+  if (thread_count == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    thread_count = online > 0 ? (size_t)online : 1;
+  }
+
+  ThreadPool *self = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+  if (!self)
+    return NULL;
+
+  self->thread_count = thread_count;
+  self->threads = (pthread_t *)malloc(
+      (thread_count > 1 ? thread_count - 1 : 1) * sizeof(pthread_t));
+  if (!self->threads) {
+    free(self);
+    return NULL;
+  }
+
+  pthread_mutex_init(&self->lock, NULL);
+  pthread_cond_init(&self->work_ready, NULL);
+  pthread_cond_init(&self->work_done, NULL);
+
+  for (; self->started + 1 < thread_count; ++self->started) {
+    ThreadPoolSlot *slot = (ThreadPoolSlot *)malloc(sizeof(ThreadPoolSlot));
+    if (!slot)
+      break;
+    *slot = (ThreadPoolSlot){self, self->started + 1};
+    if (pthread_create(&self->threads[self->started], NULL,
+                       ThreadPool__thread_main, slot) != 0) {
+      free(slot);
+      break;
+    }
+  }
+
+  if (self->started + 1 < thread_count) {
+    ThreadPool__drop(self);
+    return NULL;
+  }
+  return self;
+}
+
+size_t ThreadPool__thread_count(const ThreadPool *self) {
+  return self->thread_count;
+}
+
+void ThreadPool__run(ThreadPool *self, ThreadPoolTask task, void *arg) {
+  pthread_mutex_lock(&self->lock);
+  self->task = task;
+  self->arg = arg;
+  self->pending = self->started;
+  self->generation++;
+  pthread_cond_broadcast(&self->work_ready);
+  pthread_mutex_unlock(&self->lock);
+
+  task(arg, 0);
+
+  pthread_mutex_lock(&self->lock);
+  while (self->pending > 0)
+    pthread_cond_wait(&self->work_done, &self->lock);
+  pthread_mutex_unlock(&self->lock);
+}
+
+void ThreadPool__drop(ThreadPool *self) {
+  if (!self)
+    return;
+
+  pthread_mutex_lock(&self->lock);
+  self->stopping = true;
+  pthread_cond_broadcast(&self->work_ready);
+  pthread_mutex_unlock(&self->lock);
+
+  for (size_t i = 0; i < self->started; ++i) {
+    pthread_join(self->threads[i], NULL);
+  }
+
+  pthread_cond_destroy(&self->work_done);
+  pthread_cond_destroy(&self->work_ready);
+  pthread_mutex_destroy(&self->lock);
+  free(self->threads);
+  free(self);
+}
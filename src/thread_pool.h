@@ -0,0 +1,46 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Task run by every worker of a pool.
+ * @param arg The argument given to ThreadPool__run.
+ * @param worker_id Index of the worker, 0 .. thread_count - 1.
+ */
+typedef void (*ThreadPoolTask)(void *arg, size_t worker_id);
+
+/**
+ * @brief A fixed set of long-lived worker threads.
+ *
+ * The calling thread always acts as worker 0, so a pool of N workers owns
+ * N - 1 threads and a single-worker pool owns none.
+ */
+typedef struct ThreadPool ThreadPool;
+
+/**
+ * @brief Starts a pool of `thread_count` workers (0 selects one per online
+ * CPU).
+ * @return The pool, or NULL on allocation or thread creation failure.
+ */
+ThreadPool *ThreadPool__new(size_t thread_count);
+
+/**
+ * @brief Returns the number of workers, including the calling thread.
+ */
+size_t ThreadPool__thread_count(const ThreadPool *self);
+
+/**
+ * @brief Runs `task` once on every worker and waits for all of them.
+ *
+ * Must not be called concurrently on the same pool.
+ */
+void ThreadPool__run(ThreadPool *self, ThreadPoolTask task, void *arg);
+
+/**
+ * @brief Stops and joins all threads, then frees the pool. Safe to call
+ * with NULL.
+ */
+void ThreadPool__drop(ThreadPool *self);
+
+#endif // THREAD_POOL_H
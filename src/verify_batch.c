@@ -0,0 +1,113 @@
+#include "verify_batch.h"
+#include "search.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+
+VerifyWorkspace *VerifyWorkspace__new(size_t thread_count) {
+  VerifyWorkspace *self = (VerifyWorkspace *)calloc(1, sizeof(VerifyWorkspace));
+  if (!self)
+    return NULL;
+
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = thread_count;
+  self->pool = ThreadPool__new(SearchOptions__effective_thread_count(&options));
+  if (!self->pool) {
+    free(self);
+    return NULL;
+  }
+  return self;
+}
+
+void VerifyWorkspace__drop(VerifyWorkspace *self) {
+  if (!self)
+    return;
+  ThreadPool__drop(self->pool);
+  free(self->scratch);
+  free(self);
+}
+
+/**
+ * @brief Makes sure every worker has `stride` bytes of scratch.
+ * @return false on allocation failure; the old scratch is kept.
+ */
+static bool VerifyWorkspace__reserve(VerifyWorkspace *self, size_t stride) {
+  if (stride <= self->scratch_stride)
+    return true;
+
+  // Keep slices 8-byte aligned for the word arrays of Proof__verify_in
+  stride = (stride + 7) & ~(size_t)7;
+  uint8_t *scratch =
+      (uint8_t *)malloc(stride * ThreadPool__thread_count(self->pool));
+  if (!scratch)
+    return false;
+  free(self->scratch);
+  self->scratch = scratch;
+  self->scratch_stride = stride;
+  return true;
+}
+
+/**
+ * @brief A batch being verified: workers claim proofs through `next`.
+ */
+typedef struct VerifyBatch {
+  const Proof *const *proofs;
+  size_t count;
+  VerificationError *results;
+  VerifyWorkspace *workspace;
+  _Atomic size_t next;
+} VerifyBatch;
+
+static void VerifyBatch__worker(void *arg, size_t worker_id) {
+  VerifyBatch *self = (VerifyBatch *)arg;
+  size_t stride = self->workspace->scratch_stride;
+  uint8_t *scratch = &self->workspace->scratch[worker_id * stride];
+  for (;;) {
+    size_t i = atomic_fetch_add_explicit(&self->next, 1, memory_order_relaxed);
+    if (i >= self->count)
+      break;
+    self->results[i] =
+        self->workspace->cache
+            ? VerifyCache__verify(self->workspace->cache, self->proofs[i],
+                                  scratch, stride)
+            : Proof__verify_in(self->proofs[i], scratch, stride);
+  }
+}
+
+void Proof__verify_batch(const Proof *const *proofs, size_t count,
+                         VerificationError *results) {
+  // A pool is not worth starting for a single proof
+  VerifyWorkspace *workspace = count > 1 ? VerifyWorkspace__new(0) : NULL;
+  if (!workspace) {
+    for (size_t i = 0; i < count; ++i) {
+      results[i] = Proof__verify(proofs[i]);
+    }
+    return;
+  }
+
+  Proof__verify_batch_in(workspace, proofs, count, results);
+  VerifyWorkspace__drop(workspace);
+}
+
+void Proof__verify_batch_in(VerifyWorkspace *workspace,
+                            const Proof *const *proofs, size_t count,
+                            VerificationError *results) {
+  size_t stride = 0;
+  for (size_t i = 0; i < count; ++i) {
+    size_t needed = Proof__verify_scratch_size(&proofs[i]->config);
+    if (needed > stride)
+      stride = needed;
+  }
+  if (!VerifyWorkspace__reserve(workspace, stride)) {
+    for (size_t i = 0; i < count; ++i) {
+      results[i] = Proof__verify(proofs[i]);
+    }
+    return;
+  }
+
+  VerifyBatch batch = {.proofs = proofs,
+                       .count = count,
+                       .results = results,
+                       .workspace = workspace};
+  atomic_init(&batch.next, 0);
+  ThreadPool__run(workspace->pool, VerifyBatch__worker, &batch);
+}
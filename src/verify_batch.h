@@ -0,0 +1,59 @@
+#ifndef VERIFY_BATCH_H
+#define VERIFY_BATCH_H
+
+#include "proof.h"
+#include "verify_cache.h"
+#include "thread_pool.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Worker pool of a batch verifier and the Proof__verify_in scratch
+ * of each worker, kept across batches so that a verifier service neither
+ * starts threads nor allocates per proof.
+ */
+typedef struct VerifyWorkspace {
+  ThreadPool *pool;
+  /** One slice of scratch_stride bytes per worker. */
+  uint8_t *scratch;
+  size_t scratch_stride;
+  /** Optional verdict cache shared by the workers; NULL by default. */
+  VerifyCache *cache;
+} VerifyWorkspace;
+
+/**
+ * @brief Starts `thread_count` verifier workers (0 selects the CPU budget
+ * of the process, see SearchOptions__effective_thread_count).
+ * @return The workspace, or NULL on allocation or thread creation failure.
+ */
+VerifyWorkspace *VerifyWorkspace__new(size_t thread_count);
+
+/**
+ * @brief Joins the workers and frees the workspace. Safe to call with NULL.
+ */
+void VerifyWorkspace__drop(VerifyWorkspace *self);
+
+/**
+ * @brief Verifies `count` proofs on a worker pool started for this batch.
+ *
+ * results[i] is what Proof__verify(proofs[i]) returns; proofs are
+ * independent, so the outcome does not depend on the number of workers.
+ * If the pool cannot be started the batch is verified on the calling
+ * thread.
+ */
+void Proof__verify_batch(const Proof *const *proofs, size_t count,
+                         VerificationError *results);
+
+/**
+ * @brief Proof__verify_batch on the workers of `workspace`.
+ *
+ * Workers claim proofs one at a time, so a few expensive proofs do not hold
+ * up the rest of the batch, and verify them with Proof__verify_in in their
+ * own scratch, grown to the largest Config of the batch. Must not be called
+ * concurrently on the same workspace.
+ */
+void Proof__verify_batch_in(VerifyWorkspace *workspace,
+                            const Proof *const *proofs, size_t count,
+                            VerificationError *results);
+
+#endif // VERIFY_BATCH_H
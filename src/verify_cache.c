@@ -0,0 +1,221 @@
+#include "verify_cache.h"
+#include "memory.h"
+#include "merkle_tree.h"
+#include <blake3.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VERIFY_CACHE_MAGIC "itsuku-verify 1"
+#define NO_ENTRY SIZE_MAX
+
+static void hash_u64(blake3_hasher *hasher, uint64_t value) {
+  uint8_t bytes[8];
+  u64_to_le_bytes(value, bytes);
+  blake3_hasher_update(hasher, bytes, sizeof(bytes));
+}
+
+static void hash_indices(blake3_hasher *hasher, const size_t *indices,
+                         size_t count) {
+  hash_u64(hasher, count);
+  for (size_t i = 0; i < count; ++i) {
+    hash_u64(hasher, indices[i]);
+  }
+}
+
+void VerifyCache__key(const Proof *proof, uint8_t key[VERIFY_CACHE_KEY_SIZE]) {
+  const Config *config = &proof->config;
+  blake3_hasher hasher;
+  blake3_hasher_init(&hasher);
+  blake3_hasher_update(&hasher, VERIFY_CACHE_MAGIC,
+                       strlen(VERIFY_CACHE_MAGIC));
+  hash_u64(&hasher, config->chunk_size);
+  hash_u64(&hasher, config->chunk_count);
+  hash_u64(&hasher, config->antecedent_count);
+  hash_u64(&hasher, config->difficulty_bits);
+  hash_u64(&hasher, config->search_length);
+  hash_u64(&hasher, proof->challenge_id.bytes_len);
+  blake3_hasher_update(&hasher, proof->challenge_id.bytes,
+                       proof->challenge_id.bytes_len);
+  hash_u64(&hasher, proof->nonce);
+
+  hash_indices(&hasher, proof->leaf_indices, proof->leaf_count);
+  uint8_t element_bytes[ELEMENT_SIZE];
+  size_t slots = proof->leaf_count * config->antecedent_count;
+  for (size_t i = 0; i < slots; ++i) {
+    Element__to_le_bytes(&proof->leaf_antecedents[i], element_bytes);
+    blake3_hasher_update(&hasher, element_bytes, ELEMENT_SIZE);
+  }
+
+  size_t node_size = MerkleTree__calculate_node_size(config);
+  hash_indices(&hasher, proof->node_indices, proof->node_count);
+  blake3_hasher_update(&hasher, proof->node_hashes,
+                       proof->node_count * node_size);
+  if (proof->root_hash)
+    blake3_hasher_update(&hasher, proof->root_hash, node_size);
+  blake3_hasher_finalize(&hasher, key, VERIFY_CACHE_KEY_SIZE);
+}
+
+VerifyCache *VerifyCache__new(size_t capacity) {
+  if (capacity == 0)
+    return NULL;
+
+  size_t bucket_count = 1;
+  while (bucket_count < capacity)
+    bucket_count <<= 1;
+
+  VerifyCache *self = (VerifyCache *)calloc(1, sizeof(VerifyCache));
+  if (!self)
+    return NULL;
+  self->entries =
+      (VerifyCacheEntry *)malloc(capacity * sizeof(VerifyCacheEntry));
+  self->buckets = (size_t *)malloc(bucket_count * sizeof(size_t));
+  if (!self->entries || !self->buckets ||
+      pthread_mutex_init(&self->lock, NULL) != 0) {
+    free(self->entries);
+    free(self->buckets);
+    free(self);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < bucket_count; ++i) {
+    self->buckets[i] = NO_ENTRY;
+  }
+  self->capacity = capacity;
+  self->bucket_mask = bucket_count - 1;
+  self->newest = NO_ENTRY;
+  self->oldest = NO_ENTRY;
+  return self;
+}
+
+void VerifyCache__drop(VerifyCache *self) {
+  if (!self)
+    return;
+  pthread_mutex_destroy(&self->lock);
+  free(self->entries);
+  free(self->buckets);
+  free(self);
+}
+
+static size_t *VerifyCache__bucket(VerifyCache *self,
+                                   const uint8_t key[VERIFY_CACHE_KEY_SIZE]) {
+  // The key is a uniform hash, so any of its words spreads the buckets
+  return &self->buckets[u64_from_le_bytes(key) & self->bucket_mask];
+}
+
+static size_t VerifyCache__find(VerifyCache *self,
+                                const uint8_t key[VERIFY_CACHE_KEY_SIZE]) {
+  size_t at = *VerifyCache__bucket(self, key);
+  while (at != NO_ENTRY &&
+         memcmp(self->entries[at].key, key, VERIFY_CACHE_KEY_SIZE) != 0)
+    at = self->entries[at].chain_next;
+  return at;
+}
+
+static void VerifyCache__unlink(VerifyCache *self, size_t at) {
+  VerifyCacheEntry *entry = &self->entries[at];
+  if (entry->newer != NO_ENTRY)
+    self->entries[entry->newer].older = entry->older;
+  else
+    self->newest = entry->older;
+  if (entry->older != NO_ENTRY)
+    self->entries[entry->older].newer = entry->newer;
+  else
+    self->oldest = entry->newer;
+}
+
+static void VerifyCache__push_newest(VerifyCache *self, size_t at) {
+  VerifyCacheEntry *entry = &self->entries[at];
+  entry->newer = NO_ENTRY;
+  entry->older = self->newest;
+  if (self->newest != NO_ENTRY)
+    self->entries[self->newest].newer = at;
+  else
+    self->oldest = at;
+  self->newest = at;
+}
+
+/**
+ * @brief Removes the least recently used entry from its hash chain and the
+ * recency list.
+ * @return The freed slot.
+ */
+static size_t VerifyCache__evict(VerifyCache *self) {
+  size_t at = self->oldest;
+  size_t *link = VerifyCache__bucket(self, self->entries[at].key);
+  while (*link != at)
+    link = &self->entries[*link].chain_next;
+  *link = self->entries[at].chain_next;
+
+  VerifyCache__unlink(self, at);
+  self->stats.evictions++;
+  return at;
+}
+
+bool VerifyCache__lookup(VerifyCache *self,
+                         const uint8_t key[VERIFY_CACHE_KEY_SIZE],
+                         VerificationError *result) {
+  pthread_mutex_lock(&self->lock);
+  size_t at = VerifyCache__find(self, key);
+  if (at == NO_ENTRY) {
+    self->stats.misses++;
+    pthread_mutex_unlock(&self->lock);
+    return false;
+  }
+
+  self->stats.hits++;
+  *result = self->entries[at].result;
+  if (at != self->newest) {
+    VerifyCache__unlink(self, at);
+    VerifyCache__push_newest(self, at);
+  }
+  pthread_mutex_unlock(&self->lock);
+  return true;
+}
+
+void VerifyCache__insert(VerifyCache *self,
+                         const uint8_t key[VERIFY_CACHE_KEY_SIZE],
+                         VerificationError result) {
+  pthread_mutex_lock(&self->lock);
+  // Threads that missed on the same proof at once all insert it
+  size_t at = VerifyCache__find(self, key);
+  if (at != NO_ENTRY) {
+    self->entries[at].result = result;
+    pthread_mutex_unlock(&self->lock);
+    return;
+  }
+
+  at = self->count < self->capacity ? self->count++ : VerifyCache__evict(self);
+  VerifyCacheEntry *entry = &self->entries[at];
+  memcpy(entry->key, key, VERIFY_CACHE_KEY_SIZE);
+  entry->result = result;
+  size_t *bucket = VerifyCache__bucket(self, key);
+  entry->chain_next = *bucket;
+  *bucket = at;
+  VerifyCache__push_newest(self, at);
+  pthread_mutex_unlock(&self->lock);
+}
+
+VerificationError VerifyCache__verify(VerifyCache *self, const Proof *proof,
+                                      void *scratch, size_t scratch_size) {
+  uint8_t key[VERIFY_CACHE_KEY_SIZE];
+  VerifyCache__key(proof, key);
+
+  VerificationError result;
+  if (VerifyCache__lookup(self, key, &result))
+    return result;
+
+  result = scratch ? Proof__verify_in(proof, scratch, scratch_size)
+                   : Proof__verify(proof);
+  // Running out of memory or scratch says nothing about the proof
+  if (result != VerificationError__RequiredElementMissing)
+    VerifyCache__insert(self, key, result);
+  return result;
+}
+
+VerifyCacheStats VerifyCache__stats(VerifyCache *self) {
+  pthread_mutex_lock(&self->lock);
+  VerifyCacheStats stats = self->stats;
+  stats.entries = self->count;
+  pthread_mutex_unlock(&self->lock);
+  return stats;
+}
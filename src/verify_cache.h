@@ -0,0 +1,101 @@
+#ifndef VERIFY_CACHE_H
+#define VERIFY_CACHE_H
+
+#include "proof.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Size in bytes of the digest identifying a proof in the cache. */
+#define VERIFY_CACHE_KEY_SIZE 32
+
+/**
+ * @brief One cached verdict. Entries are linked into a hash chain and into
+ * the recency list by index.
+ */
+typedef struct VerifyCacheEntry {
+  uint8_t key[VERIFY_CACHE_KEY_SIZE];
+  VerificationError result;
+  size_t chain_next;
+  size_t newer;
+  size_t older;
+} VerifyCacheEntry;
+
+/**
+ * @brief Counters of a VerifyCache.
+ */
+typedef struct VerifyCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t entries;
+} VerifyCacheStats;
+
+/**
+ * @brief Bounded least-recently-used cache of verification results.
+ *
+ * Proofs are identified by a BLAKE3 digest of everything Proof__verify
+ * reads: the Config, the challenge, the nonce and the whole opening. Equal
+ * digests therefore mean equal verdicts, errors included. One mutex guards
+ * the table, so a cache can be shared by any number of verifier threads;
+ * verification itself runs outside the lock.
+ */
+typedef struct VerifyCache {
+  pthread_mutex_t lock;
+  size_t capacity;
+  size_t count;
+  VerifyCacheEntry *entries;
+  size_t *buckets;
+  size_t bucket_mask;
+  size_t newest;
+  size_t oldest;
+  VerifyCacheStats stats;
+} VerifyCache;
+
+/**
+ * @brief Allocates a cache remembering up to `capacity` verdicts.
+ * @return The cache, or NULL on allocation failure or capacity 0.
+ */
+VerifyCache *VerifyCache__new(size_t capacity);
+
+/**
+ * @brief Frees the cache. Safe to call with NULL.
+ */
+void VerifyCache__drop(VerifyCache *self);
+
+/**
+ * @brief Computes the digest under which the verdict for `proof` is cached.
+ */
+void VerifyCache__key(const Proof *proof, uint8_t key[VERIFY_CACHE_KEY_SIZE]);
+
+/**
+ * @brief Looks up a verdict and marks it as the most recently used.
+ * @return true on a hit, with the verdict in `*result`.
+ */
+bool VerifyCache__lookup(VerifyCache *self,
+                         const uint8_t key[VERIFY_CACHE_KEY_SIZE],
+                         VerificationError *result);
+
+/**
+ * @brief Stores a verdict, evicting the least recently used one when full.
+ */
+void VerifyCache__insert(VerifyCache *self,
+                         const uint8_t key[VERIFY_CACHE_KEY_SIZE],
+                         VerificationError result);
+
+/**
+ * @brief Verifies `proof`, answering repeated submissions from the cache.
+ *
+ * With a `scratch` buffer (see Proof__verify_in) a miss is verified without
+ * allocation; with NULL it goes through Proof__verify.
+ */
+VerificationError VerifyCache__verify(VerifyCache *self, const Proof *proof,
+                                      void *scratch, size_t scratch_size);
+
+/**
+ * @brief Returns a consistent snapshot of the counters.
+ */
+VerifyCacheStats VerifyCache__stats(VerifyCache *self);
+
+#endif // VERIFY_CACHE_H
@@ -0,0 +1,191 @@
+#define _POSIX_C_SOURCE 200809L // read, MSG_NOSIGNAL
+
+#include "work_protocol.h"
+#include "memory.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Sequential little-endian writer/reader over a frame buffer.
+ */
+typedef struct FrameCursor {
+  uint8_t *data;
+  size_t len;
+  size_t pos;
+  bool ok;
+} FrameCursor;
+
+static void FrameCursor__put_u64(FrameCursor *self, uint64_t value) {
+  if (self->pos + 8 > self->len) {
+    self->ok = false;
+    return;
+  }
+  u64_to_le_bytes(value, &self->data[self->pos]);
+  self->pos += 8;
+}
+
+static uint64_t FrameCursor__get_u64(FrameCursor *self) {
+  if (self->pos + 8 > self->len) {
+    self->ok = false;
+    return 0;
+  }
+  uint64_t value = u64_from_le_bytes(&self->data[self->pos]);
+  self->pos += 8;
+  return value;
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+  return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 |
+         (uint32_t)in[3] << 24;
+}
+
+size_t WorkMessage__encode(const WorkMessage *message, uint8_t *frame) {
+  FrameCursor cursor = {.data = frame, .len = WORK_FRAME_MAX, .pos = 4,
+                        .ok = true};
+  frame[cursor.pos++] = (uint8_t)message->type;
+  FrameCursor__put_u64(&cursor, message->job_id);
+
+  switch (message->type) {
+  case WorkMessage__Job:
+    if (message->challenge_len > WORK_CHALLENGE_MAX)
+      return 0;
+    FrameCursor__put_u64(&cursor, message->config.chunk_size);
+    FrameCursor__put_u64(&cursor, message->config.chunk_count);
+    FrameCursor__put_u64(&cursor, message->config.antecedent_count);
+    FrameCursor__put_u64(&cursor, message->config.difficulty_bits);
+    FrameCursor__put_u64(&cursor, message->config.search_length);
+    FrameCursor__put_u64(&cursor, message->start);
+    FrameCursor__put_u64(&cursor, message->end);
+    FrameCursor__put_u64(&cursor, message->stride);
+    FrameCursor__put_u64(&cursor, message->share_difficulty_bits);
+    FrameCursor__put_u64(&cursor, message->challenge_len);
+    memcpy(&frame[cursor.pos], message->challenge, message->challenge_len);
+    cursor.pos += message->challenge_len;
+    break;
+  case WorkMessage__Result:
+    FrameCursor__put_u64(&cursor, (uint64_t)message->status);
+    FrameCursor__put_u64(&cursor, message->nonce);
+    FrameCursor__put_u64(&cursor, message->nonces_tried);
+    break;
+  case WorkMessage__Share:
+    FrameCursor__put_u64(&cursor, message->nonce);
+    FrameCursor__put_u64(&cursor, message->leading_zeros);
+    break;
+  case WorkMessage__Request:
+  case WorkMessage__Stop:
+    break;
+  default:
+    return 0;
+  }
+
+  if (!cursor.ok)
+    return 0;
+  put_u32(frame, (uint32_t)(cursor.pos - 4));
+  return cursor.pos;
+}
+
+long WorkMessage__decode(const uint8_t *buffer, size_t len,
+                         WorkMessage *message) {
+  if (len < 4)
+    return 0;
+  size_t payload = get_u32(buffer);
+  if (payload < 9 || payload > WORK_FRAME_MAX - 4)
+    return -1;
+  if (len < 4 + payload)
+    return 0;
+
+  FrameCursor cursor = {.data = (uint8_t *)buffer, .len = 4 + payload,
+                        .pos = 5, .ok = true};
+  memset(message, 0, sizeof(*message));
+  message->type = (WorkMessageType)buffer[4];
+  message->job_id = FrameCursor__get_u64(&cursor);
+
+  switch (message->type) {
+  case WorkMessage__Job:
+    message->config.chunk_size = FrameCursor__get_u64(&cursor);
+    message->config.chunk_count = FrameCursor__get_u64(&cursor);
+    message->config.antecedent_count = FrameCursor__get_u64(&cursor);
+    message->config.difficulty_bits = FrameCursor__get_u64(&cursor);
+    message->config.search_length = FrameCursor__get_u64(&cursor);
+    message->start = FrameCursor__get_u64(&cursor);
+    message->end = FrameCursor__get_u64(&cursor);
+    message->stride = FrameCursor__get_u64(&cursor);
+    message->share_difficulty_bits = FrameCursor__get_u64(&cursor);
+    message->challenge_len = FrameCursor__get_u64(&cursor);
+    if (!cursor.ok || message->challenge_len > WORK_CHALLENGE_MAX ||
+        cursor.pos + message->challenge_len != cursor.len)
+      return -1;
+    memcpy(message->challenge, &buffer[cursor.pos], message->challenge_len);
+    cursor.pos += message->challenge_len;
+    break;
+  case WorkMessage__Result:
+    message->status = (SearchStatus)FrameCursor__get_u64(&cursor);
+    message->nonce = FrameCursor__get_u64(&cursor);
+    message->nonces_tried = FrameCursor__get_u64(&cursor);
+    break;
+  case WorkMessage__Share:
+    message->nonce = FrameCursor__get_u64(&cursor);
+    message->leading_zeros = FrameCursor__get_u64(&cursor);
+    break;
+  case WorkMessage__Request:
+  case WorkMessage__Stop:
+    break;
+  default:
+    return -1;
+  }
+
+  if (!cursor.ok || cursor.pos != cursor.len)
+    return -1;
+  return (long)cursor.len;
+}
+
+bool WorkMessage__send(int fd, const WorkMessage *message) {
+  uint8_t frame[WORK_FRAME_MAX];
+  size_t len = WorkMessage__encode(message, frame);
+  if (len == 0)
+    return false;
+
+  for (size_t sent = 0; sent < len;) {
+    // A vanished peer is an error, not a SIGPIPE
+    ssize_t n = send(fd, &frame[sent], len - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    sent += (size_t)n;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads exactly `len` bytes.
+ */
+static bool read_exact(int fd, uint8_t *out, size_t len) {
+  for (size_t got = 0; got < len;) {
+    ssize_t n = read(fd, &out[got], len - got);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return false;
+    got += (size_t)n;
+  }
+  return true;
+}
+
+bool WorkMessage__recv(int fd, WorkMessage *message) {
+  uint8_t frame[WORK_FRAME_MAX];
+  if (!read_exact(fd, frame, 4))
+    return false;
+  size_t payload = get_u32(frame);
+  if (payload > WORK_FRAME_MAX - 4 || !read_exact(fd, &frame[4], payload))
+    return false;
+  return WorkMessage__decode(frame, 4 + payload, message) > 0;
+}
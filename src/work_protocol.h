@@ -0,0 +1,87 @@
+#ifndef WORK_PROTOCOL_H
+#define WORK_PROTOCOL_H
+
+#include "config.h"
+#include "search.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Largest challenge a job can carry, in bytes. */
+#define WORK_CHALLENGE_MAX 256
+
+/** Largest encoded frame (a Job), length prefix included. */
+#define WORK_FRAME_MAX (4 + 1 + 8 + 8 * 10 + WORK_CHALLENGE_MAX)
+
+/**
+ * @brief Kinds of messages between a coordinator and its workers.
+ */
+typedef enum WorkMessageType {
+  /** Worker -> coordinator: ready for a job. */
+  WorkMessage__Request = 1,
+  /** Coordinator -> worker: search a nonce range of a challenge. */
+  WorkMessage__Job,
+  /** Worker -> coordinator: outcome of a job. */
+  WorkMessage__Result,
+  /** Worker -> coordinator: a nonce that met the share difficulty. */
+  WorkMessage__Share,
+  /** Coordinator -> worker: abandon any job and disconnect. */
+  WorkMessage__Stop,
+} WorkMessageType;
+
+/**
+ * @brief One protocol message; only the fields of its type are meaningful.
+ *
+ * On the wire a message is a frame: a little-endian u32 payload length,
+ * then the type byte, the job id and the fields of the type as
+ * little-endian integers. Frames carry no host-specific data, so the same
+ * format works over any stream socket.
+ */
+typedef struct WorkMessage {
+  WorkMessageType type;
+  uint64_t job_id;
+
+  // Job
+  Config config;
+  uint64_t start;
+  uint64_t end;
+  uint64_t stride;
+  size_t share_difficulty_bits; // 0 when the coordinator wants no shares
+  size_t challenge_len;
+  uint8_t challenge[WORK_CHALLENGE_MAX];
+
+  // Result and Share
+  SearchStatus status;
+  /** The winner when Found, else the last nonce of the searched prefix. */
+  uint64_t nonce;
+  uint64_t nonces_tried;
+  size_t leading_zeros;
+} WorkMessage;
+
+/**
+ * @brief Encodes `message` into `frame` (WORK_FRAME_MAX bytes).
+ * @return The frame length, or 0 if the message cannot be encoded.
+ */
+size_t WorkMessage__encode(const WorkMessage *message, uint8_t *frame);
+
+/**
+ * @brief Decodes the frame at the start of `buffer` if it is complete.
+ * @return The frame length, 0 if more bytes are needed, or -1 if the frame
+ * is malformed.
+ */
+long WorkMessage__decode(const uint8_t *buffer, size_t len,
+                         WorkMessage *message);
+
+/**
+ * @brief Encodes and writes a whole frame to the socket `fd`.
+ * @return false on I/O error.
+ */
+bool WorkMessage__send(int fd, const WorkMessage *message);
+
+/**
+ * @brief Blocks until a whole frame has been read from `fd`.
+ * @return false on end of stream, I/O error or a malformed frame.
+ */
+bool WorkMessage__recv(int fd, WorkMessage *message);
+
+#endif // WORK_PROTOCOL_H
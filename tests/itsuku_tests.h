@@ -42,9 +42,48 @@ void test_merkle_node_size();
 void test_merkle_tree_allocation();
 void test_merkle_root_matches_rust();
 void test_merkle_trace_node();
+void test_merkle_aligned_stride();
+void test_merkle_multiproof_indices();
 
 // GROUP 5 (Proof)
 void test_proof_leading_zeros();
 void test_proof_search_and_verify_success();
+void test_proof_verify_rejects_tampered_opening();
+void test_proof_compatibility_views();
+void test_proof_omega_lanes_match_scalar();
+void test_proof_omega_full_matches_wrapper();
+void test_proof_verify_batch();
+void test_proof_verify_in_scratch();
+void test_proof_verify_root_engine();
+void test_proof_verify_cache();
+void test_proof_verify_stage_order();
+
+// GROUP 6 (Search)
+void test_search_multithreaded_deterministic();
+void test_search_first_found();
+void test_search_range_partitioning();
+void test_search_cancel_deadline_progress();
+void test_search_interleave_depth();
+void test_search_stats();
+void test_nonce_queue_bounded();
+void test_search_many_solutions();
+void test_search_checkpoint_resume();
+void test_search_shares();
+void test_search_step();
+void test_search_async();
+void test_search_forked();
+void test_cpu_quota();
+void test_search_duty_cycle();
+
+// GROUP 7 (Solver)
+void test_thread_pool_runs_every_worker();
+void test_solver_reuses_memory();
+void test_solver_rebuilds_for_new_challenge();
+void test_pipeline_builds_next_challenge();
+
+// GROUP 8 (Coordinator)
+void test_work_protocol_roundtrip();
+void test_coordinator_lowest_nonce();
+void test_coordinator_empty_range();
 
 #endif // ITSUKU_TESTS_H
@@ -47,14 +47,59 @@ int main() {
   test_merkle_tree_allocation();
   test_merkle_root_matches_rust();
   test_merkle_trace_node();
+  test_merkle_aligned_stride();
+  test_merkle_multiproof_indices();
   printf("--- Merkle Tree Tests Completed ---\n");
 
   // GROUP 5: PROOF-OF-WORK
   printf("\n--- GROUP 5: Proof-of-Work Tests ---\n");
   test_proof_leading_zeros();
   test_proof_search_and_verify_success();
+  test_proof_verify_rejects_tampered_opening();
+  test_proof_compatibility_views();
+  test_proof_omega_lanes_match_scalar();
+  test_proof_omega_full_matches_wrapper();
+  test_proof_verify_batch();
+  test_proof_verify_in_scratch();
+  test_proof_verify_root_engine();
+  test_proof_verify_cache();
+  test_proof_verify_stage_order();
   printf("--- Proof-of-Work Tests Completed ---\n");
 
+  // GROUP 6: SEARCH ENGINE
+  printf("\n--- GROUP 6: Search Engine Tests ---\n");
+  test_search_multithreaded_deterministic();
+  test_search_first_found();
+  test_search_range_partitioning();
+  test_search_cancel_deadline_progress();
+  test_search_interleave_depth();
+  test_search_stats();
+  test_nonce_queue_bounded();
+  test_search_many_solutions();
+  test_search_checkpoint_resume();
+  test_search_shares();
+  test_search_step();
+  test_search_async();
+  test_search_forked();
+  test_cpu_quota();
+  test_search_duty_cycle();
+  printf("--- Search Engine Tests Completed ---\n");
+
+  // GROUP 7: SOLVER
+  printf("\n--- GROUP 7: Solver Tests ---\n");
+  test_thread_pool_runs_every_worker();
+  test_solver_reuses_memory();
+  test_solver_rebuilds_for_new_challenge();
+  test_pipeline_builds_next_challenge();
+  printf("--- Solver Tests Completed ---\n");
+
+  // GROUP 8: COORDINATOR
+  printf("\n--- GROUP 8: Coordinator Tests ---\n");
+  test_work_protocol_roundtrip();
+  test_coordinator_lowest_nonce();
+  test_coordinator_empty_range();
+  printf("--- Coordinator Tests Completed ---\n");
+
   // Summary
   if (total_errors > 0) {
     fprintf(stderr, "\n\n!!! RESULT: Failure (%d errors) !!!\n", total_errors);
@@ -0,0 +1,192 @@
+#define _POSIX_C_SOURCE 200809L // sockets
+
+#include "../src/coordinator.h"
+#include "../src/proof.h"
+#include "../src/solver.h"
+#include "../src/work_protocol.h"
+#include "itsuku_tests.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// =================================================================
+// GROUP 8: COORDINATOR
+// =================================================================
+
+#define TEST_SOCKET_PATH "itsuku_test_coordinator.sock"
+
+void test_work_protocol_roundtrip() {
+  const char *name = "Work Protocol Roundtrip";
+  printf("  [Test] %s\n", name);
+
+  WorkMessage job = {.type = WorkMessage__Job,
+                     .job_id = 7,
+                     .config = Config__default(),
+                     .start = 1,
+                     .end = UINT64_MAX,
+                     .stride = 3,
+                     .share_difficulty_bits = 4,
+                     .challenge_len = 3,
+                     .challenge = {0xAA, 0xBB, 0xCC}};
+  uint8_t frame[WORK_FRAME_MAX];
+  size_t len = WorkMessage__encode(&job, frame);
+  TEST_ASSERT(len > 0 && len <= WORK_FRAME_MAX, name);
+
+  WorkMessage decoded;
+  TEST_ASSERT(WorkMessage__decode(frame, len, &decoded) == (long)len, name);
+  TEST_ASSERT(decoded.type == WorkMessage__Job && decoded.job_id == 7, name);
+  TEST_ASSERT(decoded.end == UINT64_MAX && decoded.stride == 3, name);
+  TEST_ASSERT(decoded.config.chunk_count == job.config.chunk_count, name);
+  TEST_ASSERT(decoded.share_difficulty_bits == 4, name);
+  TEST_ASSERT(decoded.challenge_len == 3 && decoded.challenge[2] == 0xCC,
+              name);
+
+  // Every proper prefix asks for more bytes
+  for (size_t prefix = 0; prefix < len; ++prefix) {
+    TEST_ASSERT(WorkMessage__decode(frame, prefix, &decoded) == 0, name);
+  }
+
+  WorkMessage result = {.type = WorkMessage__Result,
+                        .job_id = 9,
+                        .status = SearchStatus__Found,
+                        .nonce = 12345,
+                        .nonces_tried = 99};
+  len = WorkMessage__encode(&result, frame);
+  TEST_ASSERT(WorkMessage__decode(frame, len, &decoded) == (long)len, name);
+  TEST_ASSERT(decoded.status == SearchStatus__Found && decoded.nonce == 12345,
+              name);
+  TEST_ASSERT(decoded.nonces_tried == 99, name);
+
+  // Unknown types and inconsistent lengths are rejected
+  frame[4] = 0x7F;
+  TEST_ASSERT(WorkMessage__decode(frame, len, &decoded) < 0, name);
+  frame[4] = WorkMessage__Result;
+  frame[0] -= 1;
+  TEST_ASSERT(WorkMessage__decode(frame, len, &decoded) < 0, name);
+}
+
+static void *run_worker(void *arg) {
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 1;
+  options.batch_size = 8;
+  *(bool *)arg = WorkWorker__run(TEST_SOCKET_PATH, &options);
+  return NULL;
+}
+
+/**
+ * @brief A worker that takes a job and vanishes without reporting.
+ */
+static void *run_vanishing_worker(void *arg) {
+  int fd = *(int *)arg;
+  WorkMessage job;
+  WorkMessage__recv(fd, &job);
+  close(fd);
+  return NULL;
+}
+
+static int connect_test_socket() {
+  struct sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, TEST_SOCKET_PATH);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd >= 0 &&
+      connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void test_coordinator_lowest_nonce() {
+  const char *name = "Coordinator Finds the Lowest Nonce";
+  printf("  [Test] %s\n", name);
+
+  Config config = Config__default();
+  config.chunk_count = 16;
+  config.chunk_size = 64;
+  config.difficulty_bits = 10;
+  ChallengeId *challenge_id = build_test_challenge_id();
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 1;
+  ItsukuSolver *solver = ItsukuSolver__new(config, &options);
+  TEST_ASSERT(solver != NULL, name);
+  if (!solver) {
+    ChallengeId__drop(challenge_id);
+    return;
+  }
+  SearchResult expected = ItsukuSolver__solve(solver, challenge_id, 10);
+  TEST_ASSERT(expected.status == SearchStatus__Found, name);
+  Proof__drop(expected.proof);
+
+  WorkCoordinator *coordinator = WorkCoordinator__new(
+      TEST_SOCKET_PATH, config, challenge_id, 1, UINT64_MAX, 1, 32, NULL);
+  TEST_ASSERT(coordinator != NULL, name);
+  if (!coordinator) {
+    ItsukuSolver__drop(solver);
+    ChallengeId__drop(challenge_id);
+    return;
+  }
+
+  // The vanishing worker queues its request before anyone else connects
+  int fd = connect_test_socket();
+  WorkMessage request = {.type = WorkMessage__Request};
+  TEST_ASSERT(fd >= 0 && WorkMessage__send(fd, &request), name);
+  pthread_t vanishing;
+  pthread_create(&vanishing, NULL, run_vanishing_worker, &fd);
+
+  pthread_t workers[2];
+  bool stopped[2] = {false, false};
+  for (int i = 0; i < 2; ++i) {
+    pthread_create(&workers[i], NULL, run_worker, &stopped[i]);
+  }
+
+  SearchResult result = WorkCoordinator__run(coordinator);
+  pthread_join(vanishing, NULL);
+  for (int i = 0; i < 2; ++i) {
+    pthread_join(workers[i], NULL);
+  }
+  WorkCoordinator__drop(coordinator);
+  TEST_ASSERT(access(TEST_SOCKET_PATH, F_OK) != 0, name);
+
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(result.last_nonce == expected.last_nonce, name);
+  TEST_ASSERT(result.nonces_tried >= expected.last_nonce - 32, name);
+  // A worker may connect too late to be served, but whoever reported the
+  // winner was still connected and was told to stop
+  TEST_ASSERT(stopped[0] || stopped[1], name);
+
+  Proof *proof = Proof__from_nonce(&solver->config, challenge_id,
+                                   solver->memory, solver->merkle_tree,
+                                   result.last_nonce);
+  TEST_ASSERT(proof != NULL, name);
+  if (proof)
+    TEST_ASSERT(Proof__verify(proof) == VerificationError__Ok, name);
+  Proof__drop(proof);
+
+  ItsukuSolver__drop(solver);
+  ChallengeId__drop(challenge_id);
+}
+
+void test_coordinator_empty_range() {
+  const char *name = "Coordinator Empty Range";
+  printf("  [Test] %s\n", name);
+
+  Config config = Config__default();
+  ChallengeId *challenge_id = build_test_challenge_id();
+  WorkCoordinator *coordinator = WorkCoordinator__new(
+      TEST_SOCKET_PATH, config, challenge_id, 100, 100, 3, 32, NULL);
+  TEST_ASSERT(coordinator != NULL, name);
+  if (coordinator) {
+    // Matches Proof__search_range: nothing searched, resume at start
+    SearchResult result = WorkCoordinator__run(coordinator);
+    TEST_ASSERT(result.status == SearchStatus__NotFoundInRange, name);
+    TEST_ASSERT(result.last_nonce == 97, name);
+    TEST_ASSERT(result.nonces_tried == 0, name);
+    WorkCoordinator__drop(coordinator);
+  }
+  ChallengeId__drop(challenge_id);
+}
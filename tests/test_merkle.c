@@ -60,6 +60,7 @@ void test_merkle_tree_allocation() {
     size_t expected_total_bytes = expected_nodes_count * expected_node_size;
 
     TEST_ASSERT(tree->node_size == expected_node_size, name);
+    TEST_ASSERT(tree->node_stride == expected_node_size, name);
     TEST_ASSERT(tree->nodes_len == expected_total_bytes, name);
 
     MerkleTree__drop(tree);
@@ -154,3 +155,83 @@ void test_merkle_trace_node() {
   Memory__drop(memory);
   ChallengeId__drop(challenge_id);
 }
+
+void test_merkle_aligned_stride() {
+  const char *name = "Merkle Aligned Node Stride";
+  printf("  [Test] %s\n", name);
+
+  Config config = Config__default();
+  config.chunk_count = 2;
+  config.chunk_size = 8;
+  config.antecedent_count = 4;
+
+  ChallengeId *challenge_id = build_test_challenge_id();
+  Memory *memory = Memory__new(config);
+  Memory__build_all_chunks(memory, challenge_id);
+  MerkleTree *packed = MerkleTree__build_for_test(config, challenge_id, memory);
+
+  size_t alignments[] = {8, 16};
+  for (size_t a = 0; a < 2; ++a) {
+    MerkleTree *tree = MerkleTree__new_with_stride(config, alignments[a]);
+    TEST_ASSERT(tree != NULL, name);
+    if (!tree)
+      continue;
+
+    MerkleTree__compute_leaf_hashes(tree, challenge_id, memory);
+    MerkleTree__compute_intermediate_nodes(tree, challenge_id);
+
+    TEST_ASSERT(tree->node_size == packed->node_size, name);
+    TEST_ASSERT(tree->node_stride == alignments[a], name);
+    TEST_ASSERT(MerkleTree__node_count(tree) == MerkleTree__node_count(packed),
+                name);
+    TEST_ASSERT(((uintptr_t)tree->nodes % alignments[a]) == 0, name);
+
+    // The padded layout must not change any logical node hash
+    for (size_t i = 0; i < MerkleTree__node_count(tree); ++i) {
+      TEST_ASSERT(memcmp(MerkleTree__get_node(tree, i),
+                         MerkleTree__get_node(packed, i),
+                         packed->node_size) == 0,
+                  name);
+    }
+
+    MerkleTree__drop(tree);
+  }
+
+  // Non power-of-two alignments are rejected
+  TEST_ASSERT(MerkleTree__new_with_stride(config, 12) == NULL, name);
+
+  MerkleTree__drop(packed);
+  Memory__drop(memory);
+  ChallengeId__drop(challenge_id);
+}
+
+void test_merkle_multiproof_indices() {
+  const char *name = "Merkle Minimal Multiproof";
+  printf("  [Test] %s\n", name);
+
+  // 16 leaves: node indices 15..30, depth 4
+  size_t out[32];
+  size_t count = 0;
+
+  // A single leaf needs exactly its authentication path siblings
+  size_t single[] = {30};
+  TEST_ASSERT(MerkleTree__multiproof_indices(single, 1, out, &count), name);
+  size_t expected_single[] = {1, 5, 13, 29};
+  TEST_ASSERT(count == 4, name);
+  TEST_ASSERT(memcmp(out, expected_single, sizeof(expected_single)) == 0, name);
+
+  // Two sibling leaves (plus a duplicate) share every ancestor
+  size_t siblings[] = {29, 30, 30};
+  TEST_ASSERT(MerkleTree__multiproof_indices(siblings, 3, out, &count), name);
+  size_t expected_siblings[] = {1, 5, 13};
+  TEST_ASSERT(count == 3, name);
+  TEST_ASSERT(memcmp(out, expected_siblings, sizeof(expected_siblings)) == 0,
+              name);
+
+  // Leaves in opposite halves: each path is needed only below the root
+  size_t spread[] = {15, 30};
+  TEST_ASSERT(MerkleTree__multiproof_indices(spread, 2, out, &count), name);
+  size_t expected_spread[] = {4, 5, 8, 13, 16, 29};
+  TEST_ASSERT(count == 6, name);
+  TEST_ASSERT(memcmp(out, expected_spread, sizeof(expected_spread)) == 0, name);
+}
@@ -3,7 +3,10 @@
 #include "../src/memory.h"
 #include "../src/merkle_tree.h"
 #include "../src/proof.h"
+#include "../src/verify_batch.h"
+#include "../src/verify_cache.h"
 #include "itsuku_tests.h"
+#include <blake3.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,6 +24,50 @@ const size_t PROOF_TEST_DIFFICULTY = 8;
 const size_t PROOF_TEST_MEMORY_SIZE =
     PROOF_TEST_CHUNK_COUNT * PROOF_TEST_CHUNK_SIZE; // 1024
 
+/**
+ * @brief Shared fixture: a built memory and Merkle tree for one challenge.
+ */
+typedef struct ProofFixture {
+  Config config;
+  ChallengeId *challenge_id;
+  Memory *memory;
+  MerkleTree *merkle_tree;
+} ProofFixture;
+
+/**
+ * @brief Builds the fixture for `config`, taking ownership of
+ * `challenge_id`.
+ */
+static ProofFixture ProofFixture__with(Config config,
+                                       ChallengeId *challenge_id) {
+  ProofFixture fixture;
+  fixture.config = config;
+  fixture.challenge_id = challenge_id;
+  fixture.memory = Memory__new(config);
+  Memory__build_all_chunks(fixture.memory, challenge_id);
+  fixture.merkle_tree =
+      MerkleTree__build_for_test(config, challenge_id, fixture.memory);
+  return fixture;
+}
+
+/**
+ * @brief The golden-standard geometry at `difficulty_bits`, over the test
+ * challenge.
+ */
+static ProofFixture ProofFixture__new(size_t difficulty_bits) {
+  Config config = Config__default();
+  config.chunk_count = PROOF_TEST_CHUNK_COUNT;
+  config.chunk_size = PROOF_TEST_CHUNK_SIZE;
+  config.difficulty_bits = difficulty_bits;
+  return ProofFixture__with(config, build_test_challenge_id());
+}
+
+static void ProofFixture__drop(ProofFixture *self) {
+  MerkleTree__drop(self->merkle_tree);
+  Memory__drop(self->memory);
+  ChallengeId__drop(self->challenge_id);
+}
+
 // =================================================================
 // GROUP 5: PROOF-OF-WORK FUNCTIONALITY
 // =================================================================
@@ -56,7 +103,10 @@ Proof *Proof__solves_and_verifies() {
   config.chunk_size = PROOF_TEST_CHUNK_SIZE;
   config.difficulty_bits = PROOF_TEST_DIFFICULTY;
 
-  ChallengeId *challenge_id = build_test_challenge_id();
+  // Proofs borrow the challenge bytes, so the challenge outlives them all
+  static ChallengeId *challenge_id = NULL;
+  if (!challenge_id)
+    challenge_id = build_test_challenge_id();
   Memory *memory = Memory__new(config);
   Memory__build_all_chunks(memory, challenge_id);
   MerkleTree *merkle_tree = MerkleTree__new(config);
@@ -84,7 +134,6 @@ Proof *Proof__solves_and_verifies() {
   // Free memory and Merkle tree resources
   MerkleTree__drop(merkle_tree);
   Memory__drop(memory);
-  ChallengeId__drop(challenge_id);
 
   return proof;
 }
@@ -102,14 +151,579 @@ void test_proof_search_and_verify_success() {
     TEST_ASSERT(proof->nonce != 0, name);
 
     // Structural validation to ensure the Proof was correctly built
-    TEST_ASSERT(HashMap__size(proof->leaf_antecedents) ==
-                    proof->config.search_length,
+    TEST_ASSERT(proof->leaf_count == proof->config.search_length,
                 "Antecedent count mismatch");
     // Number of nodes in the tree opening should be close to L * 2
-    TEST_ASSERT(HashMap__size(proof->tree_opening) >
-                    proof->config.search_length,
+    TEST_ASSERT(proof->node_count > proof->config.search_length,
                 "Tree opening size is too small");
 
     Proof__drop(proof);
   }
 }
+
+void test_proof_verify_rejects_tampered_opening() {
+  const char *name = "Proof Verify Rejects Tampered Opening";
+  printf("  [Test] %s\n", name);
+
+  Proof *proof = Proof__solves_and_verifies();
+  TEST_ASSERT(proof != NULL, name);
+  if (!proof)
+    return;
+
+  // The multiproof never ships the root node or the opened leaves; the
+  // claimed root travels separately
+  size_t memory_size = proof->config.chunk_count * proof->config.chunk_size;
+  TEST_ASSERT(Proof__get_node(proof, 0) == NULL, name);
+  for (size_t i = 0; i < proof->leaf_count; ++i) {
+    TEST_ASSERT(Proof__get_node(proof, memory_size - 1 +
+                                           proof->leaf_indices[i]) == NULL,
+                name);
+  }
+
+  // Flipping a bit in any sibling changes the recomputed root
+  proof->node_hashes[0] ^= 0x01;
+  TEST_ASSERT(Proof__verify(proof) != VerificationError__Ok, name);
+  proof->node_hashes[0] ^= 0x01;
+
+  // A derived node that is opened anyway must match the recomputation:
+  // prepend a bogus root (index 0 keeps the arrays sorted)
+  size_t node_size = MerkleTree__calculate_node_size(&proof->config);
+  size_t count = proof->node_count + 1;
+  size_t *indices = (size_t *)malloc(count * sizeof(size_t));
+  uint8_t *hashes = (uint8_t *)calloc(count, node_size);
+  indices[0] = 0;
+  memcpy(&indices[1], proof->node_indices, proof->node_count * sizeof(size_t));
+  memcpy(&hashes[node_size], proof->node_hashes, proof->node_count * node_size);
+  free(proof->node_indices);
+  free(proof->node_hashes);
+  proof->node_indices = indices;
+  proof->node_hashes = hashes;
+  proof->node_count = count;
+  TEST_ASSERT(Proof__verify(proof) ==
+                  VerificationError__IntermediateHashMismatch,
+              name);
+
+  // Unsorted indices are rejected before any hashing
+  indices[0] = indices[1] + 1;
+  TEST_ASSERT(Proof__verify(proof) == VerificationError__MalformedProofPath,
+              name);
+
+  Proof__drop(proof);
+}
+
+void test_proof_compatibility_views() {
+  const char *name = "Proof HashMap Compatibility Views";
+  printf("  [Test] %s\n", name);
+
+  Proof *proof = Proof__solves_and_verifies();
+  TEST_ASSERT(proof != NULL, name);
+  if (!proof)
+    return;
+
+  HashMap leaves = Proof__leaf_antecedents_map(proof);
+  HashMap nodes = Proof__tree_opening_map(proof);
+  TEST_ASSERT(HashMap__size(leaves) == proof->leaf_count, name);
+  TEST_ASSERT(HashMap__size(nodes) == proof->node_count, name);
+
+  // Views borrow the flat storage instead of copying it
+  for (size_t i = 0; i < proof->leaf_count; ++i) {
+    size_t count = 0;
+    const Element *antecedents =
+        Proof__get_antecedents(proof, proof->leaf_indices[i], &count);
+    TEST_ASSERT(count >= 1, name);
+    TEST_ASSERT(HashMap__get(leaves, proof->leaf_indices[i]) == antecedents,
+                name);
+  }
+  for (size_t i = 0; i < proof->node_count; ++i) {
+    TEST_ASSERT(HashMap__get(nodes, proof->node_indices[i]) ==
+                    Proof__get_node(proof, proof->node_indices[i]),
+                name);
+  }
+
+  HashMap__drop(leaves);
+  HashMap__drop(nodes);
+  Proof__drop(proof);
+}
+
+void test_proof_omega_lanes_match_scalar() {
+  const char *name = "Proof Multi-lane Omega Matches Scalar";
+  printf("  [Test] %s\n", name);
+
+  // The lane hasher against the reference for every block boundary case
+  const size_t lengths[] = {0, 1, 63, 64, 65, 128, 136, 640, 1023, 1024};
+  uint8_t messages[BLAKE3_LANE_COUNT][BLAKE3_LANE_MAX_INPUT];
+  const uint8_t *inputs[BLAKE3_LANE_COUNT];
+  for (size_t l = 0; l < BLAKE3_LANE_COUNT; ++l) {
+    for (size_t i = 0; i < BLAKE3_LANE_MAX_INPUT; ++i) {
+      messages[l][i] = (uint8_t)(i * 31 + l * 7);
+    }
+    inputs[l] = messages[l];
+  }
+  for (size_t t = 0; t < sizeof(lengths) / sizeof(lengths[0]); ++t) {
+    uint8_t outputs[BLAKE3_LANE_COUNT][BLAKE3_LANE_OUTPUT];
+    size_t lane_count = t % 2 ? BLAKE3_LANE_COUNT : 3;
+    Blake3Lanes__hash(inputs, lengths[t], lane_count, outputs);
+
+    for (size_t l = 0; l < lane_count; ++l) {
+      uint8_t expected[BLAKE3_LANE_OUTPUT];
+      blake3_hasher hasher;
+      blake3_hasher_init(&hasher);
+      blake3_hasher_update(&hasher, messages[l], lengths[t]);
+      blake3_hasher_finalize(&hasher, expected, BLAKE3_LANE_OUTPUT);
+      TEST_ASSERT(memcmp(outputs[l], expected, BLAKE3_LANE_OUTPUT) == 0,
+                  name);
+    }
+  }
+
+  // Batched Omega against the scalar chain, including a search length whose
+  // final message no longer fits a single chunk
+  ProofFixture fixture = ProofFixture__new(Config__default().difficulty_bits);
+  Config config = fixture.config;
+  const ChallengeId *challenge_id = fixture.challenge_id;
+  const Memory *memory = fixture.memory;
+  uint8_t root_hash[64];
+  TEST_ASSERT(Proof__padded_root(fixture.merkle_tree, root_hash), name);
+
+  const size_t search_lengths[] = {config.search_length, 20};
+  for (size_t s = 0; s < 2; ++s) {
+    config.search_length = search_lengths[s];
+    size_t L = config.search_length;
+    uint8_t (*scratch)[64] = malloc(BLAKE3_LANE_COUNT * (L + 1) * 64);
+    uint8_t (*path)[64] = malloc((L + 1) * 64);
+    size_t *leaves = malloc(L * sizeof(size_t));
+
+    uint64_t nonces[BLAKE3_LANE_COUNT];
+    uint8_t omegas[BLAKE3_LANE_COUNT][64];
+    size_t lane_count = s == 0 ? BLAKE3_LANE_COUNT : 5;
+    for (size_t l = 0; l < lane_count; ++l) {
+      nonces[l] = 1000 + 17 * l;
+    }
+    Proof__calculate_omega_lanes(omegas, nonces, lane_count, scratch, &config,
+                                 challenge_id, Memory__as_partial(memory),
+                                 root_hash, PROOF_TEST_MEMORY_SIZE);
+
+    for (size_t l = 0; l < lane_count; ++l) {
+      uint8_t expected[64];
+      Proof__calculate_omega_no_alloc(
+          expected, leaves, path, &config, challenge_id,
+          Memory__as_partial(memory), (PartialMerkleTree_Wrapper){0},
+          root_hash, PROOF_TEST_MEMORY_SIZE, nonces[l]);
+      TEST_ASSERT(memcmp(omegas[l], expected, 64) == 0, name);
+    }
+
+    free(scratch);
+    free(path);
+    free(leaves);
+  }
+
+  // Several lane groups in flight, the last one partial
+  config.search_length = Config__default().search_length;
+  size_t L = config.search_length;
+  size_t in_flight = 2 * BLAKE3_LANE_COUNT + 3;
+  uint8_t (*scratch)[64] = malloc(in_flight * (L + 1) * 64);
+  uint8_t (*omegas)[64] = malloc(in_flight * 64);
+  uint8_t (*path)[64] = malloc((L + 1) * 64);
+  size_t *leaves = malloc(L * sizeof(size_t));
+  uint64_t nonces[2 * BLAKE3_LANE_COUNT + 3];
+  for (size_t n = 0; n < in_flight; ++n) {
+    nonces[n] = 5 + 3 * n;
+  }
+  Proof__calculate_omega_interleaved(
+      omegas, nonces, in_flight, scratch, &config, challenge_id,
+      Memory__as_partial(memory), root_hash, PROOF_TEST_MEMORY_SIZE);
+  for (size_t n = 0; n < in_flight; ++n) {
+    uint8_t expected[64];
+    Proof__calculate_omega_no_alloc(
+        expected, leaves, path, &config, challenge_id,
+        Memory__as_partial(memory), (PartialMerkleTree_Wrapper){0}, root_hash,
+        PROOF_TEST_MEMORY_SIZE, nonces[n]);
+    TEST_ASSERT(memcmp(omegas[n], expected, 64) == 0, name);
+  }
+  free(scratch);
+  free(omegas);
+  free(path);
+  free(leaves);
+
+  ProofFixture__drop(&fixture);
+}
+
+void test_proof_omega_full_matches_wrapper() {
+  const char *name = "Proof Full-memory Omega Matches Wrapper";
+  printf("  [Test] %s\n", name);
+
+  // Power-of-two chunks use shifts, other sizes fall back to division
+  const size_t chunk_sizes[] = {PROOF_TEST_CHUNK_SIZE, 48};
+  for (size_t c = 0; c < 2; ++c) {
+    Config config = Config__default();
+    config.chunk_count = PROOF_TEST_CHUNK_COUNT;
+    config.chunk_size = chunk_sizes[c];
+    ProofFixture fixture =
+        ProofFixture__with(config, build_test_challenge_id());
+    const ChallengeId *challenge_id = fixture.challenge_id;
+    const Memory *memory = fixture.memory;
+    size_t memory_size = config.chunk_count * config.chunk_size;
+    size_t L = config.search_length;
+    uint8_t root_hash[64] = {0x5a};
+
+    size_t count = BLAKE3_LANE_COUNT + 3;
+    uint64_t nonces[BLAKE3_LANE_COUNT + 3];
+    for (size_t n = 0; n < count; ++n) {
+      nonces[n] = 77 + n;
+    }
+    uint8_t (*scratch)[64] = malloc(count * (L + 1) * 64);
+    uint8_t (*full)[64] = malloc(count * 64);
+    uint8_t (*wrapped)[64] = malloc(count * 64);
+
+    Proof__calculate_omega_full(full, nonces, count, scratch, &config,
+                                challenge_id, memory, root_hash);
+    Proof__calculate_omega_interleaved(wrapped, nonces, count, scratch,
+                                       &config, challenge_id,
+                                       Memory__as_partial(memory), root_hash,
+                                       memory_size);
+    TEST_ASSERT(memcmp(full, wrapped, count * 64) == 0, name);
+
+    free(scratch);
+    free(full);
+    free(wrapped);
+    ProofFixture__drop(&fixture);
+  }
+}
+
+void test_proof_verify_batch() {
+  const char *name = "Proof Batch Verification Matches Serial";
+  printf("  [Test] %s\n", name);
+
+  ProofFixture fixture = ProofFixture__new(6);
+  Proof *found[4] = {NULL};
+  size_t found_count = 0;
+  SearchResult result = Proof__search_many(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, 1, UINT64_MAX, 1, 4, NULL, found, &found_count);
+  TEST_ASSERT(result.status == SearchStatus__Found && found_count == 4, name);
+
+  // Break proofs in different ways: a sibling hash, the nonce, a leaf
+  if (found_count == 4) {
+    found[1]->node_hashes[0] ^= 0x01;
+    found[2]->nonce += 1;
+    found[3]->leaf_antecedents[0].data[0] ^= 0x01;
+  }
+
+  const size_t count = 37;
+  const Proof *proofs[37];
+  VerificationError expected[37];
+  VerificationError results[37];
+  for (size_t i = 0; i < count; ++i) {
+    proofs[i] = found[i % found_count];
+    expected[i] = Proof__verify(proofs[i]);
+  }
+  TEST_ASSERT(expected[0] == VerificationError__Ok, name);
+  TEST_ASSERT(expected[1] != VerificationError__Ok, name);
+  TEST_ASSERT(expected[3] != VerificationError__Ok, name);
+
+  Proof__verify_batch(proofs, count, results);
+  TEST_ASSERT(memcmp(results, expected, sizeof(expected)) == 0, name);
+
+  VerifyWorkspace *workspace = VerifyWorkspace__new(4);
+  TEST_ASSERT(workspace != NULL, name);
+  if (workspace) {
+    for (int run = 0; run < 3; ++run) {
+      memset(results, 0xFF, sizeof(results));
+      Proof__verify_batch_in(workspace, proofs, count, results);
+      TEST_ASSERT(memcmp(results, expected, sizeof(expected)) == 0, name);
+    }
+    // Empty batches are fine
+    Proof__verify_batch_in(workspace, proofs, 0, results);
+  }
+  VerifyWorkspace__drop(workspace);
+
+  for (size_t i = 0; i < found_count; ++i) {
+    Proof__drop(found[i]);
+  }
+  ProofFixture__drop(&fixture);
+}
+
+void test_proof_verify_in_scratch() {
+  const char *name = "Proof Verify in Caller Scratch";
+  printf("  [Test] %s\n", name);
+
+  Proof *proof = Proof__solves_and_verifies();
+  TEST_ASSERT(proof != NULL, name);
+  if (!proof)
+    return;
+
+  size_t scratch_size = Proof__verify_scratch_size(&proof->config);
+  uint8_t *scratch = (uint8_t *)malloc(scratch_size);
+  TEST_ASSERT(scratch != NULL, name);
+  if (!scratch) {
+    Proof__drop(proof);
+    return;
+  }
+
+  // Stale contents of a reused buffer do not matter
+  memset(scratch, 0xA5, scratch_size);
+  TEST_ASSERT(Proof__verify_in(proof, scratch, scratch_size) ==
+                  VerificationError__Ok,
+              name);
+  TEST_ASSERT(Proof__verify_in(proof, scratch, scratch_size - 1) ==
+                  VerificationError__RequiredElementMissing,
+              name);
+
+  // Errors match the allocating verifier
+  proof->node_hashes[0] ^= 0x01;
+  TEST_ASSERT(Proof__verify_in(proof, scratch, scratch_size) ==
+                  Proof__verify(proof),
+              name);
+  proof->node_hashes[0] ^= 0x01;
+
+  // More opened leaves than the path can visit do not fit the scratch
+  size_t leaf_count = proof->leaf_count;
+  proof->leaf_count = proof->config.search_length + 1;
+  TEST_ASSERT(Proof__verify_in(proof, scratch, scratch_size) ==
+                  VerificationError__MalformedProofPath,
+              name);
+  proof->leaf_count = leaf_count;
+
+  free(scratch);
+  Proof__drop(proof);
+}
+
+/**
+ * @brief Adds an opened node with a bogus hash, keeping the indices sorted.
+ */
+static void Proof__open_bogus_node(Proof *proof, size_t node_index) {
+  size_t node_size = MerkleTree__calculate_node_size(&proof->config);
+  size_t count = proof->node_count + 1;
+  size_t *indices = (size_t *)malloc(count * sizeof(size_t));
+  uint8_t *hashes = (uint8_t *)calloc(count, node_size);
+  size_t at = 0;
+  while (at < proof->node_count && proof->node_indices[at] < node_index)
+    ++at;
+
+  memcpy(indices, proof->node_indices, at * sizeof(size_t));
+  memcpy(hashes, proof->node_hashes, at * node_size);
+  indices[at] = node_index;
+  memcpy(&indices[at + 1], &proof->node_indices[at],
+         (proof->node_count - at) * sizeof(size_t));
+  memcpy(&hashes[(at + 1) * node_size], &proof->node_hashes[at * node_size],
+         (proof->node_count - at) * node_size);
+
+  free(proof->node_indices);
+  free(proof->node_hashes);
+  proof->node_indices = indices;
+  proof->node_hashes = hashes;
+  proof->node_count = count;
+}
+
+void test_proof_verify_root_engine() {
+  const char *name = "Proof Verify Root Recomputation";
+  printf("  [Test] %s\n", name);
+
+  // A wrong opened copy of the parent of a leaf is caught on the way up
+  Proof *proof = Proof__solves_and_verifies();
+  TEST_ASSERT(proof != NULL, name);
+  if (proof) {
+    size_t memory_size = proof->config.chunk_count * proof->config.chunk_size;
+    size_t leaf_node = memory_size - 1 + proof->leaf_indices[0];
+    Proof__open_bogus_node(proof, (leaf_node - 1) / 2);
+    TEST_ASSERT(Proof__verify(proof) ==
+                    VerificationError__IntermediateHashMismatch,
+                name);
+    Proof__drop(proof);
+  }
+
+  // Parent messages beyond the lane hasher's limit take the scalar path
+  Config config = Config__default();
+  config.chunk_count = PROOF_TEST_CHUNK_COUNT;
+  config.chunk_size = PROOF_TEST_CHUNK_SIZE;
+  config.difficulty_bits = 4;
+  uint8_t bytes[1100];
+  for (size_t i = 0; i < sizeof(bytes); ++i) {
+    bytes[i] = (uint8_t)(i * 7);
+  }
+  ProofFixture fixture =
+      ProofFixture__with(config, ChallengeId__new(bytes, sizeof(bytes)));
+
+  proof = Proof__search(config, fixture.challenge_id, fixture.memory,
+                        fixture.merkle_tree);
+  TEST_ASSERT(proof != NULL, name);
+  if (proof) {
+    TEST_ASSERT(Proof__verify(proof) == VerificationError__Ok, name);
+    proof->node_hashes[proof->node_count - 1] ^= 0x80;
+    TEST_ASSERT(Proof__verify(proof) != VerificationError__Ok, name);
+    Proof__drop(proof);
+  }
+
+  ProofFixture__drop(&fixture);
+}
+
+void test_proof_verify_cache() {
+  const char *name = "Proof Verification Cache";
+  printf("  [Test] %s\n", name);
+
+  ProofFixture fixture = ProofFixture__new(6);
+  Proof *found[3] = {NULL};
+  size_t found_count = 0;
+  Proof__search_many(fixture.config, fixture.challenge_id, fixture.memory,
+                     fixture.merkle_tree, 1, UINT64_MAX, 1, 3, NULL, found,
+                     &found_count);
+  TEST_ASSERT(found_count == 3, name);
+  VerifyCache *cache = VerifyCache__new(2);
+  TEST_ASSERT(cache != NULL, name);
+  if (found_count != 3 || !cache) {
+    for (size_t i = 0; i < found_count; ++i) {
+      Proof__drop(found[i]);
+    }
+    VerifyCache__drop(cache);
+    ProofFixture__drop(&fixture);
+    return;
+  }
+
+  // Any change to the opening changes the key
+  uint8_t key[VERIFY_CACHE_KEY_SIZE], tampered_key[VERIFY_CACHE_KEY_SIZE];
+  VerifyCache__key(found[1], key);
+  found[1]->node_hashes[0] ^= 0x01;
+  VerifyCache__key(found[1], tampered_key);
+  TEST_ASSERT(memcmp(key, tampered_key, sizeof(key)) != 0, name);
+
+  // Verdicts, errors included, are remembered
+  TEST_ASSERT(VerifyCache__verify(cache, found[0], NULL, 0) ==
+                  VerificationError__Ok,
+              name);
+  VerificationError tampered = Proof__verify(found[1]);
+  TEST_ASSERT(tampered != VerificationError__Ok, name);
+  TEST_ASSERT(VerifyCache__verify(cache, found[1], NULL, 0) == tampered,
+              name);
+  TEST_ASSERT(VerifyCache__verify(cache, found[0], NULL, 0) ==
+                  VerificationError__Ok,
+              name);
+  TEST_ASSERT(VerifyCache__verify(cache, found[1], NULL, 0) == tampered,
+              name);
+  VerifyCacheStats stats = VerifyCache__stats(cache);
+  TEST_ASSERT(stats.hits == 2 && stats.misses == 2, name);
+  TEST_ASSERT(stats.entries == 2 && stats.evictions == 0, name);
+
+  // A third proof evicts the least recently used one (found[0])
+  VerificationError result;
+  VerifyCache__verify(cache, found[2], NULL, 0);
+  VerifyCache__key(found[0], key);
+  TEST_ASSERT(!VerifyCache__lookup(cache, key, &result), name);
+  TEST_ASSERT(VerifyCache__lookup(cache, tampered_key, &result) &&
+                  result == tampered,
+              name);
+  stats = VerifyCache__stats(cache);
+  TEST_ASSERT(stats.evictions == 1 && stats.entries == 2, name);
+  VerifyCache__drop(cache);
+
+  // Shared by batch workers, every duplicate after the first is a hit
+  cache = VerifyCache__new(16);
+  VerifyWorkspace *workspace = VerifyWorkspace__new(4);
+  TEST_ASSERT(cache != NULL && workspace != NULL, name);
+  if (cache && workspace) {
+    workspace->cache = cache;
+    const Proof *proofs[30];
+    VerificationError results[30];
+    for (size_t i = 0; i < 30; ++i) {
+      proofs[i] = found[i % 3];
+    }
+    Proof__verify_batch_in(workspace, proofs, 30, results);
+    Proof__verify_batch_in(workspace, proofs, 30, results);
+    for (size_t i = 0; i < 30; ++i) {
+      TEST_ASSERT(results[i] == Proof__verify(proofs[i]), name);
+    }
+    stats = VerifyCache__stats(cache);
+    TEST_ASSERT(stats.hits + stats.misses == 60, name);
+    TEST_ASSERT(stats.misses >= 3 && stats.entries == 3, name);
+  }
+  VerifyWorkspace__drop(workspace);
+  VerifyCache__drop(cache);
+
+  for (size_t i = 0; i < found_count; ++i) {
+    Proof__drop(found[i]);
+  }
+  ProofFixture__drop(&fixture);
+}
+
+void test_proof_verify_stage_order() {
+  const char *name = "Proof Verify Rejects Cheapest First";
+  printf("  [Test] %s\n", name);
+
+  Proof *proof = Proof__solves_and_verifies();
+  TEST_ASSERT(proof != NULL, name);
+  if (!proof)
+    return;
+
+  // A tampered leaf changes its element and fails in the Omega walk
+  proof->leaf_antecedents[0].data[0] ^= 0x01;
+  VerificationError leaf_error = Proof__verify(proof);
+  TEST_ASSERT(leaf_error == VerificationError__UnprovenLeafInPath ||
+                  leaf_error == VerificationError__DifficultyNotMet,
+              name);
+
+  // Dropping a sibling is caught from indices alone, before any hashing
+  size_t node_count = proof->node_count;
+  proof->node_count = node_count - 1;
+  TEST_ASSERT(Proof__verify(proof) == VerificationError__MissingChildNode,
+              name);
+  proof->node_count = node_count;
+  proof->leaf_antecedents[0].data[0] ^= 0x01;
+
+  // Nothing opened or no claimed root means no root
+  size_t leaf_count = proof->leaf_count;
+  proof->leaf_count = 0;
+  TEST_ASSERT(Proof__verify(proof) == VerificationError__MissingMerkleRoot,
+              name);
+  proof->leaf_count = leaf_count;
+  uint8_t *root_hash = proof->root_hash;
+  proof->root_hash = NULL;
+  TEST_ASSERT(Proof__verify(proof) == VerificationError__MissingMerkleRoot,
+              name);
+  proof->root_hash = root_hash;
+
+  // A wrong nonce or claimed root fails in the Omega walk
+  proof->nonce += 1;
+  VerificationError omega_error = Proof__verify(proof);
+  TEST_ASSERT(omega_error == VerificationError__UnprovenLeafInPath ||
+                  omega_error == VerificationError__DifficultyNotMet,
+              name);
+  proof->nonce -= 1;
+  proof->root_hash[0] ^= 0x01;
+  omega_error = Proof__verify(proof);
+  TEST_ASSERT(omega_error == VerificationError__UnprovenLeafInPath ||
+                  omega_error == VerificationError__DifficultyNotMet,
+              name);
+  proof->root_hash[0] ^= 0x01;
+
+  // Past the difficulty, the paths must reproduce the claimed root
+  proof->node_hashes[0] ^= 0x01;
+  TEST_ASSERT(Proof__verify(proof) ==
+                  VerificationError__IntermediateHashMismatch,
+              name);
+  proof->node_hashes[0] ^= 0x01;
+  TEST_ASSERT(Proof__verify(proof) == VerificationError__Ok, name);
+  Proof__drop(proof);
+
+  // A consistent opening below the difficulty is rejected before any leaf
+  // or path hashing: a bogus opened leaf and a corrupt sibling, which those
+  // stages would report, go unnoticed
+  ProofFixture fixture = ProofFixture__new(PROOF_TEST_DIFFICULTY);
+  proof = NULL;
+  for (uint64_t nonce = 1; nonce < 64 && !proof; ++nonce) {
+    proof = Proof__from_nonce(&fixture.config, fixture.challenge_id,
+                              fixture.memory, fixture.merkle_tree, nonce);
+    if (proof && Proof__verify(proof) != VerificationError__DifficultyNotMet) {
+      Proof__drop(proof);
+      proof = NULL;
+    }
+  }
+  TEST_ASSERT(proof != NULL, name);
+  if (proof) {
+    Proof__open_bogus_node(proof,
+                           PROOF_TEST_MEMORY_SIZE - 1 + proof->leaf_indices[0]);
+    proof->node_hashes[proof->node_count - 1] ^= 0x01;
+    TEST_ASSERT(Proof__verify(proof) == VerificationError__DifficultyNotMet,
+                name);
+    Proof__drop(proof);
+  }
+
+  ProofFixture__drop(&fixture);
+}
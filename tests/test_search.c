@@ -0,0 +1,984 @@
+#define _POSIX_C_SOURCE 200809L // mkdir, rmdir, clock_gettime
+
+#include "../src/checkpoint.h"
+#include "../src/config.h"
+#include "../src/cpu_quota.h"
+#include "../src/memory.h"
+#include "../src/merkle_tree.h"
+#include "../src/nonce_queue.h"
+#include "../src/proof.h"
+#include "../src/search.h"
+#include "../src/search_async.h"
+#include "../src/search_fork.h"
+#include "itsuku_tests.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// --- Auxiliary Function Declaration (from test_merkle.c) ---
+extern MerkleTree *MerkleTree__build_for_test(Config config,
+                                              ChallengeId *challenge_id,
+                                              Memory *memory);
+
+// =================================================================
+// GROUP 6: SEARCH ENGINE
+// =================================================================
+
+/**
+ * @brief Shared fixture: a small built memory and Merkle tree.
+ */
+typedef struct SearchFixture {
+  Config config;
+  ChallengeId *challenge_id;
+  Memory *memory;
+  MerkleTree *merkle_tree;
+} SearchFixture;
+
+static SearchFixture SearchFixture__new(size_t difficulty_bits) {
+  SearchFixture fixture;
+  fixture.config = Config__default();
+  fixture.config.chunk_count = 16;
+  fixture.config.chunk_size = 64;
+  fixture.config.difficulty_bits = difficulty_bits;
+
+  fixture.challenge_id = build_test_challenge_id();
+  fixture.memory = Memory__new(fixture.config);
+  Memory__build_all_chunks(fixture.memory, fixture.challenge_id);
+  fixture.merkle_tree =
+      MerkleTree__build_for_test(fixture.config, fixture.challenge_id,
+                                 fixture.memory);
+  return fixture;
+}
+
+static void SearchFixture__drop(SearchFixture *self) {
+  MerkleTree__drop(self->merkle_tree);
+  Memory__drop(self->memory);
+  ChallengeId__drop(self->challenge_id);
+}
+
+void test_search_multithreaded_deterministic() {
+  const char *name = "Search Multi-threaded Lowest Nonce";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+
+  SearchOptions single = SearchOptions__default();
+  single.thread_count = 1;
+  Proof *expected = Proof__search_with_options(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, &single);
+  TEST_ASSERT(expected != NULL, name);
+
+  // Small batches force many claims and concurrent winners
+  SearchOptions parallel = SearchOptions__default();
+  parallel.thread_count = 4;
+  parallel.batch_size = 3;
+  for (int run = 0; run < 4 && expected; ++run) {
+    Proof *proof = Proof__search_with_options(
+        fixture.config, fixture.challenge_id, fixture.memory,
+        fixture.merkle_tree, &parallel);
+    TEST_ASSERT(proof != NULL, name);
+    if (proof) {
+      TEST_ASSERT(proof->nonce == expected->nonce, name);
+      TEST_ASSERT(Proof__verify(proof) == VerificationError__Ok, name);
+      Proof__drop(proof);
+    }
+  }
+
+  Proof__drop(expected);
+  SearchFixture__drop(&fixture);
+}
+
+void test_search_first_found() {
+  const char *name = "Search Multi-threaded First Found";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 4;
+  options.lowest_nonce = false;
+  Proof *proof =
+      Proof__search_with_options(fixture.config, fixture.challenge_id,
+                                 fixture.memory, fixture.merkle_tree, &options);
+
+  TEST_ASSERT(proof != NULL, name);
+  if (proof) {
+    TEST_ASSERT(Proof__verify(proof) == VerificationError__Ok, name);
+    Proof__drop(proof);
+  }
+
+  SearchFixture__drop(&fixture);
+}
+
+void test_search_range_partitioning() {
+  const char *name = "Search Nonce Ranges";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 2;
+  options.batch_size = 5;
+
+  SearchResult full =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(full.status == SearchStatus__Found, name);
+  if (full.status != SearchStatus__Found) {
+    SearchFixture__drop(&fixture);
+    return;
+  }
+  uint64_t winner = full.proof->nonce;
+  TEST_ASSERT(full.last_nonce == winner, name);
+
+  // The range just below the winner is exhausted and resumes at the winner
+  SearchResult below =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, winner, 1, &options);
+  TEST_ASSERT(below.status == SearchStatus__NotFoundInRange, name);
+  TEST_ASSERT(below.proof == NULL, name);
+  TEST_ASSERT(below.last_nonce == winner - 1, name);
+
+  SearchResult resumed = Proof__search_range(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, below.last_nonce + 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(resumed.status == SearchStatus__Found, name);
+  if (resumed.proof) {
+    TEST_ASSERT(resumed.proof->nonce == winner, name);
+    Proof__drop(resumed.proof);
+  }
+
+  // Two strided workers cover the whole range; the better one is the winner
+  uint64_t best = UINT64_MAX;
+  for (uint64_t worker = 0; worker < 2; ++worker) {
+    SearchResult part = Proof__search_range(
+        fixture.config, fixture.challenge_id, fixture.memory,
+        fixture.merkle_tree, 1 + worker, UINT64_MAX, 2, &options);
+    TEST_ASSERT(part.status == SearchStatus__Found, name);
+    if (part.proof) {
+      TEST_ASSERT((part.proof->nonce - 1 - worker) % 2 == 0, name);
+      TEST_ASSERT(Proof__verify(part.proof) == VerificationError__Ok, name);
+      if (part.proof->nonce < best)
+        best = part.proof->nonce;
+      Proof__drop(part.proof);
+    }
+  }
+  TEST_ASSERT(best == winner, name);
+
+  // An empty range evaluates nothing
+  SearchResult empty =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 7, 7, 1, &options);
+  TEST_ASSERT(empty.status == SearchStatus__NotFoundInRange, name);
+
+  Proof__drop(full.proof);
+  SearchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Progress callback used by the tests: counts reports and raises the
+ * cancellation flag once `cancel_after` nonces were tried.
+ */
+typedef struct ProgressProbe {
+  size_t reports;
+  uint64_t last_tried;
+  uint64_t cancel_after;
+  atomic_bool cancel;
+} ProgressProbe;
+
+static void ProgressProbe__report(const SearchProgress *progress,
+                                  void *user_data) {
+  ProgressProbe *probe = (ProgressProbe *)user_data;
+  probe->reports++;
+  probe->last_tried = progress->nonces_tried;
+  if (probe->cancel_after && progress->nonces_tried >= probe->cancel_after)
+    atomic_store(&probe->cancel, true);
+}
+
+void test_search_cancel_deadline_progress() {
+  const char *name = "Search Cancellation, Deadline and Progress";
+  printf("  [Test] %s\n", name);
+
+  // 512 bits cannot be reached, so only the controls can end the search
+  SearchFixture fixture = SearchFixture__new(512);
+  ProgressProbe probe = {0};
+  atomic_init(&probe.cancel, false);
+
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 2;
+  options.batch_size = 4;
+  options.progress = ProgressProbe__report;
+  options.progress_user_data = &probe;
+  options.progress_interval = 10;
+
+  // Progress fires every 10 nonces of an exhausted range
+  SearchResult bounded =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, 101, 1, &options);
+  TEST_ASSERT(bounded.status == SearchStatus__NotFoundInRange, name);
+  TEST_ASSERT(bounded.nonces_tried == 100, name);
+  TEST_ASSERT(bounded.last_nonce == 100, name);
+  TEST_ASSERT(probe.reports == 10, name);
+  TEST_ASSERT(probe.last_tried == 100, name);
+
+  // A raised flag stops the search before any work is done
+  atomic_store(&probe.cancel, true);
+  options.cancel_flag = &probe.cancel;
+  SearchResult cancelled =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(cancelled.status == SearchStatus__Cancelled, name);
+  TEST_ASSERT(cancelled.proof == NULL, name);
+  TEST_ASSERT(cancelled.nonces_tried == 0, name);
+  TEST_ASSERT(cancelled.last_nonce + 1 == 1, name);
+
+  // Cancelling from the callback leaves a fully evaluated prefix; the
+  // group already in flight still completes, so at most one group of
+  // min(interleave, batch_size) nonces runs past the flag
+  atomic_store(&probe.cancel, false);
+  probe.cancel_after = 30;
+  options.thread_count = 1;
+  SearchResult stopped =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(stopped.status == SearchStatus__Cancelled, name);
+  TEST_ASSERT(stopped.nonces_tried >= 30, name);
+  TEST_ASSERT(stopped.nonces_tried < 30 + options.batch_size, name);
+  TEST_ASSERT(stopped.last_nonce == stopped.nonces_tried, name);
+
+  // A short deadline ends an unbounded search
+  options.cancel_flag = NULL;
+  options.progress = NULL;
+  options.deadline_seconds = 0.05;
+  SearchResult expired =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(expired.status == SearchStatus__DeadlineExceeded, name);
+  TEST_ASSERT(expired.proof == NULL, name);
+  TEST_ASSERT(expired.nonces_tried > 0, name);
+
+  SearchFixture__drop(&fixture);
+}
+
+void test_search_interleave_depth() {
+  const char *name = "Search Interleave Depth";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 1;
+  options.batch_size = 50;
+
+  // Any number of nonces in flight finds the same lowest nonce
+  const size_t depths[] = {1, 8, 20, OMEGA_MAX_IN_FLIGHT, 1000};
+  uint64_t expected = 0;
+  for (size_t i = 0; i < sizeof(depths) / sizeof(depths[0]); ++i) {
+    options.interleave = depths[i];
+    Proof *proof = Proof__search_with_options(
+        fixture.config, fixture.challenge_id, fixture.memory,
+        fixture.merkle_tree, &options);
+    TEST_ASSERT(proof != NULL, name);
+    if (!proof)
+      continue;
+    if (i == 0)
+      expected = proof->nonce;
+    TEST_ASSERT(proof->nonce == expected, name);
+    Proof__drop(proof);
+  }
+
+  SearchFixture__drop(&fixture);
+}
+
+void test_search_stats() {
+  const char *name = "Search Statistics";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchStats stats;
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 2;
+  options.batch_size = 16;
+  options.stats = &stats;
+
+  Proof *proof =
+      Proof__search_with_options(fixture.config, fixture.challenge_id,
+                                 fixture.memory, fixture.merkle_tree, &options);
+  TEST_ASSERT(proof != NULL, name);
+
+  uint64_t evaluated = atomic_load(&stats.nonces_evaluated);
+  uint64_t per_thread = 0;
+  for (size_t i = 0; i < SEARCH_STATS_MAX_THREADS; ++i) {
+    per_thread += atomic_load(&stats.thread_nonces[i]);
+  }
+  TEST_ASSERT(atomic_load(&stats.thread_count) == 2, name);
+  TEST_ASSERT(per_thread == evaluated, name);
+  TEST_ASSERT(proof == NULL || evaluated >= proof->nonce, name);
+  TEST_ASSERT(atomic_load(&stats.element_reads) ==
+                  evaluated * fixture.config.search_length,
+              name);
+  TEST_ASSERT(atomic_load(&stats.best_leading_zeros) >=
+                  fixture.config.difficulty_bits,
+              name);
+  TEST_ASSERT(SearchStats__time_to_solution(&stats) >= 0, name);
+  TEST_ASSERT(SearchStats__time_to_solution(&stats) <=
+                  SearchStats__elapsed_seconds(&stats),
+              name);
+  TEST_ASSERT(SearchStats__hashrate(&stats) > 0, name);
+
+  // The same struct is reset by the next search; an empty-handed one has
+  // no time to solution
+  SearchResult bounded =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, 3, 1, &options);
+  TEST_ASSERT(bounded.status == SearchStatus__NotFoundInRange ||
+                  bounded.status == SearchStatus__Found,
+              name);
+  if (bounded.status == SearchStatus__NotFoundInRange) {
+    TEST_ASSERT(atomic_load(&stats.nonces_evaluated) == 2, name);
+    TEST_ASSERT(SearchStats__time_to_solution(&stats) < 0, name);
+  }
+  Proof__drop(bounded.proof);
+
+  Proof__drop(proof);
+  SearchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Producer thread for the queue test: pushes `count` distinct values.
+ */
+typedef struct QueueProducer {
+  NonceQueue *queue;
+  uint64_t first;
+  uint64_t count;
+  uint64_t rejected;
+} QueueProducer;
+
+static void *QueueProducer__run(void *arg) {
+  QueueProducer *producer = (QueueProducer *)arg;
+  for (uint64_t i = 0; i < producer->count; ++i) {
+    if (!NonceQueue__push(producer->queue, producer->first + i))
+      ++producer->rejected;
+  }
+  return NULL;
+}
+
+void test_nonce_queue_bounded() {
+  const char *name = "Nonce Queue Bounded MPMC";
+  printf("  [Test] %s\n", name);
+
+  // Capacity is rounded up to a power of two
+  NonceQueue *queue = NonceQueue__new(5);
+  TEST_ASSERT(queue != NULL, name);
+  if (!queue)
+    return;
+  for (uint64_t i = 0; i < 8; ++i) {
+    TEST_ASSERT(NonceQueue__push(queue, 100 + i), name);
+  }
+  TEST_ASSERT(!NonceQueue__push(queue, 999), name);
+
+  uint64_t value = 0;
+  for (uint64_t i = 0; i < 8; ++i) {
+    TEST_ASSERT(NonceQueue__pop(queue, &value) && value == 100 + i, name);
+  }
+  TEST_ASSERT(!NonceQueue__pop(queue, &value), name);
+
+  // The cells are reused on the next lap
+  TEST_ASSERT(NonceQueue__push(queue, 7), name);
+  TEST_ASSERT(NonceQueue__pop(queue, &value) && value == 7, name);
+  NonceQueue__drop(queue);
+
+  // Concurrent producers overfilling the queue lose exactly the excess
+  queue = NonceQueue__new(1024);
+  QueueProducer producers[4];
+  pthread_t threads[4];
+  for (size_t t = 0; t < 4; ++t) {
+    producers[t] = (QueueProducer){
+        .queue = queue, .first = t * 1000, .count = 300, .rejected = 0};
+    pthread_create(&threads[t], NULL, QueueProducer__run, &producers[t]);
+  }
+  uint64_t rejected = 0;
+  for (size_t t = 0; t < 4; ++t) {
+    pthread_join(threads[t], NULL);
+    rejected += producers[t].rejected;
+  }
+  TEST_ASSERT(rejected == 4 * 300 - 1024, name);
+
+  bool seen[4000] = {false};
+  size_t popped = 0;
+  bool distinct = true;
+  while (NonceQueue__pop(queue, &value)) {
+    distinct = distinct && value < 4000 && !seen[value];
+    if (value < 4000)
+      seen[value] = true;
+    ++popped;
+  }
+  TEST_ASSERT(popped == 1024, name);
+  TEST_ASSERT(distinct, name);
+  NonceQueue__drop(queue);
+}
+
+void test_search_many_solutions() {
+  const char *name = "Search Multiple Solutions";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(8);
+  SearchOptions single = SearchOptions__default();
+  single.thread_count = 1;
+
+  // Reference: the first four winners, one search at a time
+  uint64_t expected[4];
+  uint64_t start = 1;
+  for (size_t i = 0; i < 4; ++i) {
+    SearchResult result = Proof__search_range(
+        fixture.config, fixture.challenge_id, fixture.memory,
+        fixture.merkle_tree, start, UINT64_MAX, 1, &single);
+    TEST_ASSERT(result.status == SearchStatus__Found, name);
+    expected[i] = result.last_nonce;
+    start = result.last_nonce + 1;
+    Proof__drop(result.proof);
+  }
+
+  Proof *proofs[4] = {NULL};
+  size_t count = 0;
+  SearchResult result = Proof__search_many(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, 1, UINT64_MAX, 1, 4, &single, proofs, &count);
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(count == 4, name);
+  for (size_t i = 0; i < count; ++i) {
+    TEST_ASSERT(proofs[i]->nonce == expected[i], name);
+    TEST_ASSERT(Proof__verify(proofs[i]) == VerificationError__Ok, name);
+    Proof__drop(proofs[i]);
+  }
+
+  // Several workers: any four distinct winners, in ascending order
+  SearchOptions parallel = SearchOptions__default();
+  parallel.thread_count = 4;
+  parallel.batch_size = 3;
+  parallel.interleave = 2;
+  result = Proof__search_many(fixture.config, fixture.challenge_id,
+                              fixture.memory, fixture.merkle_tree, 1,
+                              UINT64_MAX, 1, 4, &parallel, proofs, &count);
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(count == 4, name);
+  for (size_t i = 0; i < count; ++i) {
+    TEST_ASSERT(i == 0 || proofs[i]->nonce > proofs[i - 1]->nonce, name);
+    TEST_ASSERT(Proof__verify(proofs[i]) == VerificationError__Ok, name);
+    Proof__drop(proofs[i]);
+  }
+
+  // A range holding only two winners returns both
+  result = Proof__search_many(fixture.config, fixture.challenge_id,
+                              fixture.memory, fixture.merkle_tree, 1,
+                              expected[1] + 1, 1, 4, &parallel, proofs,
+                              &count);
+  TEST_ASSERT(result.status == SearchStatus__NotFoundInRange, name);
+  TEST_ASSERT(count == 2, name);
+  TEST_ASSERT(result.last_nonce == expected[1], name);
+  for (size_t i = 0; i < count; ++i) {
+    TEST_ASSERT(proofs[i]->nonce == expected[i], name);
+    Proof__drop(proofs[i]);
+  }
+
+  SearchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Progress callback of the checkpoint test: checks that the frontier
+ * never moves backwards, then hands the report to the checkpoint writer.
+ */
+typedef struct FrontierProbe {
+  SearchCheckpointWriter writer;
+  uint64_t last_frontier;
+  uint64_t reports;
+  bool monotonic;
+} FrontierProbe;
+
+static void FrontierProbe__report(const SearchProgress *progress,
+                                  void *user_data) {
+  FrontierProbe *probe = (FrontierProbe *)user_data;
+  if (progress->next_nonce < probe->last_frontier)
+    probe->monotonic = false;
+  probe->last_frontier = progress->next_nonce;
+  ++probe->reports;
+  SearchCheckpointWriter__report(progress, &probe->writer);
+}
+
+void test_search_checkpoint_resume() {
+  const char *name = "Search Checkpoint Resume";
+  printf("  [Test] %s\n", name);
+
+  const char *path = "itsuku_test_checkpoint";
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 3;
+  options.batch_size = 5;
+  options.interleave = 2;
+
+  Proof *winner = Proof__search_with_options(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, &options);
+  TEST_ASSERT(winner != NULL, name);
+  if (!winner) {
+    SearchFixture__drop(&fixture);
+    return;
+  }
+
+  // Sweep the nonces below the winner, checkpointing on every report
+  FrontierProbe probe = {.last_frontier = 0, .monotonic = true};
+  probe.writer = (SearchCheckpointWriter){
+      .checkpoint = SearchCheckpoint__new(&fixture.config,
+                                          fixture.challenge_id, 1, 1),
+      .path = path,
+      .interval_seconds = 0,
+  };
+  options.progress = FrontierProbe__report;
+  options.progress_user_data = &probe;
+  options.progress_interval = 1;
+  SearchResult below = Proof__search_range(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, 1, winner->nonce, 1, &options);
+  TEST_ASSERT(below.status == SearchStatus__NotFoundInRange, name);
+  TEST_ASSERT(probe.reports > 0, name);
+  TEST_ASSERT(probe.monotonic, name);
+  TEST_ASSERT(probe.last_frontier <= winner->nonce, name);
+
+  // A restart picks up the saved frontier and finds the same winner
+  SearchCheckpoint restored =
+      SearchCheckpoint__new(&fixture.config, fixture.challenge_id, 1, 1);
+  TEST_ASSERT(SearchCheckpoint__load(&restored, path), name);
+  TEST_ASSERT(restored.next_nonce == probe.writer.checkpoint.next_nonce, name);
+  TEST_ASSERT(restored.next_nonce > 1, name);
+  TEST_ASSERT(restored.next_nonce <= winner->nonce, name);
+
+  options.progress = NULL;
+  SearchResult resumed = Proof__search_range(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, restored.next_nonce, UINT64_MAX, 1, &options);
+  TEST_ASSERT(resumed.status == SearchStatus__Found, name);
+  TEST_ASSERT(resumed.last_nonce == winner->nonce, name);
+  Proof__drop(resumed.proof);
+
+  // The file is ignored by any other search
+  Config harder = fixture.config;
+  harder.difficulty_bits += 1;
+  SearchCheckpoint other =
+      SearchCheckpoint__new(&harder, fixture.challenge_id, 1, 1);
+  TEST_ASSERT(!SearchCheckpoint__load(&other, path), name);
+  TEST_ASSERT(other.next_nonce == 1, name);
+  other = SearchCheckpoint__new(&fixture.config, fixture.challenge_id, 2, 2);
+  TEST_ASSERT(!SearchCheckpoint__load(&other, path), name);
+
+  remove(path);
+  TEST_ASSERT(!SearchCheckpoint__load(&restored, path), name);
+
+  Proof__drop(winner);
+  SearchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Share callback of the share test: records nonces and checks each
+ * reported Omega.
+ */
+typedef struct ShareProbe {
+  uint64_t nonces[512];
+  size_t count;
+  bool valid;
+} ShareProbe;
+
+static void ShareProbe__report(const SearchShare *share, void *user_data) {
+  ShareProbe *probe = (ShareProbe *)user_data;
+  if (share->leading_zeros < 4 ||
+      Proof__leading_zeros(share->omega, 64) != share->leading_zeros)
+    probe->valid = false;
+  if (probe->count < 512)
+    probe->nonces[probe->count] = share->nonce;
+  ++probe->count;
+}
+
+void test_search_shares() {
+  const char *name = "Search Share Difficulty";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchStats stats;
+  ShareProbe probe = {.count = 0, .valid = true};
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 1;
+  options.share_difficulty_bits = 4;
+  options.share = ShareProbe__report;
+  options.share_user_data = &probe;
+  options.stats = &stats;
+
+  SearchResult result =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(probe.valid, name);
+  TEST_ASSERT(probe.count <= 512, name);
+  TEST_ASSERT(atomic_load(&stats.shares_found) == probe.count, name);
+
+  // Exactly the evaluated nonces meeting the share difficulty, winner
+  // included
+  uint8_t root_hash[64];
+  Proof__padded_root(fixture.merkle_tree, root_hash);
+  uint8_t (*scratch)[64] =
+      malloc((fixture.config.search_length + 1) * sizeof(*scratch));
+  size_t expected = 0;
+  bool winner_reported = false;
+  for (uint64_t nonce = 1; nonce <= result.nonces_tried && scratch; ++nonce) {
+    uint8_t omega[1][64];
+    Proof__calculate_omega_full(omega, &nonce, 1, scratch, &fixture.config,
+                                fixture.challenge_id, fixture.memory,
+                                root_hash);
+    if (Proof__leading_zeros(omega[0], 64) < 4)
+      continue;
+    TEST_ASSERT(expected < probe.count && probe.nonces[expected] == nonce,
+                name);
+    winner_reported = winner_reported || nonce == result.last_nonce;
+    ++expected;
+  }
+  TEST_ASSERT(expected == probe.count, name);
+  TEST_ASSERT(winner_reported, name);
+  free(scratch);
+  Proof__drop(result.proof);
+
+  // Share difficulty 0 disables the callback
+  probe.count = 0;
+  options.share_difficulty_bits = 0;
+  result = Proof__search_range(fixture.config, fixture.challenge_id,
+                               fixture.memory, fixture.merkle_tree, 1,
+                               UINT64_MAX, 1, &options);
+  TEST_ASSERT(probe.count == 0, name);
+  TEST_ASSERT(atomic_load(&stats.shares_found) == 0, name);
+  Proof__drop(result.proof);
+
+  SearchFixture__drop(&fixture);
+}
+
+void test_search_step() {
+  const char *name = "Search Step-wise State";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions single = SearchOptions__default();
+  single.thread_count = 1;
+  SearchResult first =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &single);
+  SearchResult second = Proof__search_range(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, first.last_nonce + 1, UINT64_MAX, 1, &single);
+  TEST_ASSERT(first.status == SearchStatus__Found, name);
+  TEST_ASSERT(second.status == SearchStatus__Found, name);
+  Proof__drop(first.proof);
+  Proof__drop(second.proof);
+
+  SearchOptions options = SearchOptions__default();
+  options.interleave = 4;
+  SearchState *state =
+      SearchState__new(fixture.config, fixture.challenge_id, fixture.memory,
+                       fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(state != NULL, name);
+  if (!state) {
+    SearchFixture__drop(&fixture);
+    return;
+  }
+
+  // Bounded steps walk the range in order until the lowest winner
+  SearchStep step = SearchStep__Continue;
+  bool bounded = true;
+  while (step == SearchStep__Continue) {
+    uint64_t before = SearchState__nonces_tried(state);
+    step = Proof__search_step(state, 7);
+    bounded = bounded && SearchState__nonces_tried(state) - before <= 7;
+  }
+  TEST_ASSERT(bounded, name);
+  TEST_ASSERT(step == SearchStep__Found, name);
+  TEST_ASSERT(SearchState__next_nonce(state) == first.last_nonce + 1, name);
+  TEST_ASSERT(SearchState__nonces_tried(state) == first.last_nonce, name);
+
+  Proof *proof = SearchState__take_proof(state);
+  TEST_ASSERT(proof != NULL && proof->nonce == first.last_nonce, name);
+  if (proof) {
+    TEST_ASSERT(Proof__verify(proof) == VerificationError__Ok, name);
+    Proof__drop(proof);
+  }
+  TEST_ASSERT(SearchState__take_proof(state) == NULL, name);
+
+  // The next steps carry on past the winner
+  do {
+    step = Proof__search_step(state, 100);
+  } while (step == SearchStep__Continue);
+  TEST_ASSERT(step == SearchStep__Found, name);
+  proof = SearchState__take_proof(state);
+  TEST_ASSERT(proof != NULL && proof->nonce == second.last_nonce, name);
+  Proof__drop(proof);
+  SearchState__drop(state);
+
+  // A range without winners ends exhausted
+  state = SearchState__new(fixture.config, fixture.challenge_id,
+                           fixture.memory, fixture.merkle_tree, 1,
+                           first.last_nonce, 1, &options);
+  TEST_ASSERT(Proof__search_step(state, 0) == SearchStep__Continue, name);
+  TEST_ASSERT(Proof__search_step(state, UINT64_MAX) == SearchStep__Exhausted,
+              name);
+  TEST_ASSERT(SearchState__next_nonce(state) == first.last_nonce, name);
+  TEST_ASSERT(SearchState__take_proof(state) == NULL, name);
+  SearchState__drop(state);
+
+  SearchFixture__drop(&fixture);
+}
+
+void test_search_async() {
+  const char *name = "Search Asynchronous Handle";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 2;
+  SearchResult expected =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(expected.status == SearchStatus__Found, name);
+  Proof__drop(expected.proof);
+
+  SearchHandle *handle =
+      Proof__search_async(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(handle != NULL, name);
+  if (handle) {
+    TEST_ASSERT(SearchHandle__wait_timeout(handle, 30.0), name);
+    TEST_ASSERT(SearchHandle__poll(handle), name);
+    SearchResult result = SearchHandle__take_result(handle);
+    TEST_ASSERT(result.status == SearchStatus__Found, name);
+    TEST_ASSERT(result.proof != NULL &&
+                    result.proof->nonce == expected.last_nonce,
+                name);
+    TEST_ASSERT(SearchHandle__take_result(handle).proof == NULL, name);
+    Proof__drop(result.proof);
+    SearchHandle__drop(handle);
+  }
+  SearchFixture__drop(&fixture);
+
+  // An unsolvable search keeps running until it is cancelled
+  fixture = SearchFixture__new(512);
+  SearchWorkspace *workspace = SearchWorkspace__new(2);
+  handle = Proof__search_async_in(workspace, fixture.config,
+                                  fixture.challenge_id, fixture.memory,
+                                  fixture.merkle_tree, 1, UINT64_MAX, 1, NULL);
+  TEST_ASSERT(handle != NULL, name);
+  if (handle) {
+    TEST_ASSERT(!SearchHandle__wait_timeout(handle, 0.05), name);
+    TEST_ASSERT(!SearchHandle__poll(handle), name);
+    SearchHandle__cancel(handle);
+    TEST_ASSERT(SearchHandle__wait_timeout(handle, 30.0), name);
+    SearchResult result = SearchHandle__take_result(handle);
+    TEST_ASSERT(result.status == SearchStatus__Cancelled, name);
+    TEST_ASSERT(result.nonces_tried > 0, name);
+    SearchHandle__drop(handle);
+  }
+
+  // Dropping a running search stops it
+  handle = Proof__search_async_in(workspace, fixture.config,
+                                  fixture.challenge_id, fixture.memory,
+                                  fixture.merkle_tree, 1, UINT64_MAX, 1, NULL);
+  TEST_ASSERT(handle != NULL, name);
+  SearchHandle__drop(handle);
+
+  SearchWorkspace__drop(workspace);
+  SearchFixture__drop(&fixture);
+}
+
+/**
+ * @brief Share callback that kills the first worker process to report a
+ * share. The marker file makes it happen once across processes.
+ */
+static void crash_once(const SearchShare *share, void *user_data) {
+  (void)share;
+  const char *marker = (const char *)user_data;
+  FILE *file = fopen(marker, "r");
+  if (file) {
+    fclose(file);
+    return;
+  }
+  file = fopen(marker, "w");
+  if (file)
+    fclose(file);
+  _Exit(3);
+}
+
+void test_search_forked() {
+  const char *name = "Search Forked Worker Processes";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 1;
+  options.batch_size = 16;
+  SearchResult expected =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(expected.status == SearchStatus__Found, name);
+  Proof__drop(expected.proof);
+
+  SearchResult result = Proof__search_forked(
+      fixture.config, fixture.challenge_id, fixture.memory,
+      fixture.merkle_tree, 1, UINT64_MAX, 1, 3, &options);
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(result.last_nonce == expected.last_nonce, name);
+  if (result.proof) {
+    TEST_ASSERT(result.proof->nonce == expected.last_nonce, name);
+    TEST_ASSERT(Proof__verify(result.proof) == VerificationError__Ok, name);
+  }
+  Proof__drop(result.proof);
+
+  // A crashed worker is replaced and its block searched again
+  const char *marker = "itsuku_test_crash_marker";
+  remove(marker);
+  options.share_difficulty_bits = 1;
+  options.share = crash_once;
+  options.share_user_data = (void *)marker;
+  result = Proof__search_forked(fixture.config, fixture.challenge_id,
+                                fixture.memory, fixture.merkle_tree, 1,
+                                UINT64_MAX, 1, 2, &options);
+  FILE *file = fopen(marker, "r");
+  TEST_ASSERT(file != NULL, name);
+  if (file)
+    fclose(file);
+  remove(marker);
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(result.last_nonce == expected.last_nonce, name);
+  Proof__drop(result.proof);
+
+  // A range without winners is searched to the end
+  options.share = NULL;
+  result = Proof__search_forked(fixture.config, fixture.challenge_id,
+                                fixture.memory, fixture.merkle_tree, 1,
+                                expected.last_nonce, 1, 2, &options);
+  TEST_ASSERT(result.status == SearchStatus__NotFoundInRange, name);
+  TEST_ASSERT(result.last_nonce == expected.last_nonce - 1, name);
+  TEST_ASSERT(result.nonces_tried == expected.last_nonce - 1, name);
+
+  // Workers whose search fails are replaced to redo their block; once the
+  // replacements run out the range has a hole and the search reports it
+  MerkleTree broken = *fixture.merkle_tree;
+  broken.nodes_len = 0;
+  result = Proof__search_forked(fixture.config, fixture.challenge_id,
+                                fixture.memory, &broken, 1,
+                                expected.last_nonce, 1, 2, &options);
+  TEST_ASSERT(result.status == SearchStatus__Error, name);
+  TEST_ASSERT(result.proof == NULL, name);
+  TEST_ASSERT(result.nonces_tried == 0, name);
+
+  SearchFixture__drop(&fixture);
+}
+
+static void write_text_file(const char *path, const char *text) {
+  FILE *file = fopen(path, "w");
+  if (file) {
+    fputs(text, file);
+    fclose(file);
+  }
+}
+
+void test_cpu_quota() {
+  const char *name = "CPU Quota from cgroup cpu.max";
+  printf("  [Test] %s\n", name);
+
+  double quota_cpus = -1;
+  TEST_ASSERT(CpuQuota__parse_cpu_max("max 100000\n", &quota_cpus), name);
+  TEST_ASSERT(quota_cpus == 0.0, name);
+  TEST_ASSERT(CpuQuota__parse_cpu_max("250000 100000\n", &quota_cpus), name);
+  TEST_ASSERT(quota_cpus == 2.5, name);
+  TEST_ASSERT(!CpuQuota__parse_cpu_max("", &quota_cpus), name);
+  TEST_ASSERT(!CpuQuota__parse_cpu_max("50000 0", &quota_cpus), name);
+  TEST_ASSERT(!CpuQuota__parse_cpu_max("lots 100000", &quota_cpus), name);
+
+  // The parent's limit is tighter than the child's and wins
+  mkdir("itsuku_test_cgroup", 0700);
+  mkdir("itsuku_test_cgroup/app", 0700);
+  mkdir("itsuku_test_cgroup/app/prover", 0700);
+  write_text_file("itsuku_test_cgroup/cpu.max", "max 100000\n");
+  write_text_file("itsuku_test_cgroup/app/cpu.max", "50000 100000\n");
+  write_text_file("itsuku_test_cgroup/app/prover/cpu.max",
+                  "300000 100000\n");
+  CpuQuota quota = CpuQuota__read("itsuku_test_cgroup", "/app/prover");
+  TEST_ASSERT(quota.available_cpus >= 1, name);
+  TEST_ASSERT(quota.quota_cpus == 0.5, name);
+  TEST_ASSERT(CpuQuota__budget(&quota) == 0.5, name);
+
+  // Unlimited everywhere leaves the available CPUs
+  write_text_file("itsuku_test_cgroup/app/cpu.max", "max 100000\n");
+  quota = CpuQuota__read("itsuku_test_cgroup", "/app/prover");
+  TEST_ASSERT(quota.quota_cpus == 3.0, name);
+  quota = CpuQuota__read("itsuku_test_cgroup", "/missing");
+  TEST_ASSERT(quota.quota_cpus == 0.0, name);
+  TEST_ASSERT(CpuQuota__budget(&quota) == (double)quota.available_cpus, name);
+
+  remove("itsuku_test_cgroup/app/prover/cpu.max");
+  remove("itsuku_test_cgroup/app/cpu.max");
+  remove("itsuku_test_cgroup/cpu.max");
+  rmdir("itsuku_test_cgroup/app/prover");
+  rmdir("itsuku_test_cgroup/app");
+  rmdir("itsuku_test_cgroup");
+
+  SearchOptions options = SearchOptions__default();
+  SearchOptions__fit_cpu_quota(&options, 0.5);
+  TEST_ASSERT(options.thread_count >= 1, name);
+  TEST_ASSERT(options.duty_cycle > 0 && options.duty_cycle <= 1, name);
+  TEST_ASSERT(SearchOptions__effective_thread_count(&options) ==
+                  options.thread_count,
+              name);
+}
+
+static double process_cpu_seconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+void test_search_duty_cycle() {
+  const char *name = "Search Duty Cycle";
+  printf("  [Test] %s\n", name);
+
+  SearchFixture fixture = SearchFixture__new(10);
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 1;
+  SearchResult expected =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  Proof__drop(expected.proof);
+
+  // Throttling changes the pace, not the result
+  options.thread_count = 2;
+  options.duty_cycle = 0.5;
+  SearchResult result =
+      Proof__search_range(fixture.config, fixture.challenge_id, fixture.memory,
+                          fixture.merkle_tree, 1, UINT64_MAX, 1, &options);
+  TEST_ASSERT(result.status == SearchStatus__Found, name);
+  TEST_ASSERT(result.last_nonce == expected.last_nonce, name);
+  Proof__drop(result.proof);
+
+  // An unreachable difficulty searched until the deadline uses about a
+  // quarter of the CPU time an unthrottled worker would
+  SearchStats stats;
+  fixture.config.difficulty_bits = 128;
+  options.thread_count = 1;
+  options.duty_cycle = 0.25;
+  options.deadline_seconds = 0.3;
+  options.stats = &stats;
+  double cpu_before = process_cpu_seconds();
+  result = Proof__search_range(fixture.config, fixture.challenge_id,
+                               fixture.memory, fixture.merkle_tree, 1,
+                               UINT64_MAX, 1, &options);
+  double cpu_used = process_cpu_seconds() - cpu_before;
+  TEST_ASSERT(result.status == SearchStatus__DeadlineExceeded, name);
+  TEST_ASSERT(cpu_used < 0.6 * SearchStats__elapsed_seconds(&stats), name);
+
+  SearchFixture__drop(&fixture);
+}
@@ -0,0 +1,226 @@
+#include "../src/config.h"
+#include "../src/memory.h"
+#include "../src/merkle_tree.h"
+#include "../src/pipeline.h"
+#include "../src/proof.h"
+#include "../src/solver.h"
+#include "../src/thread_pool.h"
+#include "itsuku_tests.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Auxiliary Function Declaration (from test_merkle.c) ---
+extern MerkleTree *MerkleTree__build_for_test(Config config,
+                                              ChallengeId *challenge_id,
+                                              Memory *memory);
+
+// =================================================================
+// GROUP 7: SOLVER
+// =================================================================
+
+static Config solver_test_config() {
+  Config config = Config__default();
+  config.chunk_count = 16;
+  config.chunk_size = 64;
+  return config;
+}
+
+/**
+ * @brief Task for the pool test: every worker marks its own slot.
+ */
+typedef struct PoolProbe {
+  _Atomic size_t calls;
+  _Atomic size_t seen[4];
+} PoolProbe;
+
+static void PoolProbe__task(void *arg, size_t worker_id) {
+  PoolProbe *probe = (PoolProbe *)arg;
+  atomic_fetch_add(&probe->calls, 1);
+  if (worker_id < 4)
+    atomic_fetch_add(&probe->seen[worker_id], 1);
+}
+
+void test_thread_pool_runs_every_worker() {
+  const char *name = "Thread Pool Runs Every Worker";
+  printf("  [Test] %s\n", name);
+
+  ThreadPool *pool = ThreadPool__new(3);
+  TEST_ASSERT(pool != NULL, name);
+  if (!pool)
+    return;
+  TEST_ASSERT(ThreadPool__thread_count(pool) == 3, name);
+
+  PoolProbe probe = {0};
+  for (int round = 0; round < 5; ++round) {
+    ThreadPool__run(pool, PoolProbe__task, &probe);
+  }
+  TEST_ASSERT(atomic_load(&probe.calls) == 15, name);
+  for (size_t i = 0; i < 3; ++i) {
+    TEST_ASSERT(atomic_load(&probe.seen[i]) == 5, name);
+  }
+  TEST_ASSERT(atomic_load(&probe.seen[3]) == 0, name);
+
+  ThreadPool__drop(pool);
+}
+
+void test_solver_reuses_memory() {
+  const char *name = "Solver Reuses Memory Across Difficulties";
+  printf("  [Test] %s\n", name);
+
+  Config config = solver_test_config();
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 2;
+  ItsukuSolver *solver = ItsukuSolver__new(config, &options);
+  TEST_ASSERT(solver != NULL, name);
+  if (!solver)
+    return;
+
+  ChallengeId *challenge_id = build_test_challenge_id();
+  Memory *memory = Memory__new(config);
+  Memory__build_all_chunks(memory, challenge_id);
+  MerkleTree *tree = NULL;
+
+  // 8 and 7 bits share a 3-byte node size, 10 bits needs 4 bytes
+  const size_t difficulties[] = {8, 7, 10};
+  ChallengeId *built_for = NULL;
+  MerkleTree *first_tree = NULL;
+  for (size_t i = 0; i < 3; ++i) {
+    SearchResult result =
+        ItsukuSolver__solve(solver, challenge_id, difficulties[i]);
+    TEST_ASSERT(result.status == SearchStatus__Found, name);
+
+    // The memory is built once for the challenge and then reused
+    if (i == 0) {
+      built_for = solver->challenge_id;
+      first_tree = solver->merkle_tree;
+    }
+    TEST_ASSERT(solver->challenge_id == built_for, name);
+    if (i == 1)
+      TEST_ASSERT(solver->merkle_tree == first_tree, name);
+
+    config.difficulty_bits = difficulties[i];
+    MerkleTree__drop(tree);
+    tree = MerkleTree__build_for_test(config, challenge_id, memory);
+    Proof *expected = Proof__search(config, challenge_id, memory, tree);
+    TEST_ASSERT(expected != NULL, name);
+    if (result.proof && expected) {
+      TEST_ASSERT(result.proof->nonce == expected->nonce, name);
+      TEST_ASSERT(result.proof->config.difficulty_bits == difficulties[i],
+                  name);
+      TEST_ASSERT(Proof__verify(result.proof) == VerificationError__Ok, name);
+    }
+    Proof__drop(expected);
+    Proof__drop(result.proof);
+  }
+
+  MerkleTree__drop(tree);
+  Memory__drop(memory);
+  ChallengeId__drop(challenge_id);
+  ItsukuSolver__drop(solver);
+}
+
+void test_solver_rebuilds_for_new_challenge() {
+  const char *name = "Solver Rebuilds for a New Challenge";
+  printf("  [Test] %s\n", name);
+
+  Config config = solver_test_config();
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 3;
+  ItsukuSolver *solver = ItsukuSolver__new(config, &options);
+  TEST_ASSERT(solver != NULL, name);
+  if (!solver)
+    return;
+
+  uint8_t bytes[32];
+  for (int challenge = 0; challenge < 2; ++challenge) {
+    memset(bytes, 0xa0 + challenge, sizeof(bytes));
+    ChallengeId *challenge_id = ChallengeId__new(bytes, sizeof(bytes));
+
+    SearchResult result = ItsukuSolver__solve(solver, challenge_id, 8);
+    TEST_ASSERT(result.status == SearchStatus__Found, name);
+
+    // The parallel build matches a sequential one
+    config.difficulty_bits = 8;
+    Memory *memory = Memory__new(config);
+    Memory__build_all_chunks(memory, challenge_id);
+    MerkleTree *tree =
+        MerkleTree__build_for_test(config, challenge_id, memory);
+    TEST_ASSERT(memcmp(MerkleTree__get_node(tree, 0),
+                       MerkleTree__get_node(solver->merkle_tree, 0),
+                       tree->node_size) == 0,
+                name);
+    if (result.proof)
+      TEST_ASSERT(Proof__verify(result.proof) == VerificationError__Ok, name);
+
+    Proof__drop(result.proof);
+    MerkleTree__drop(tree);
+    Memory__drop(memory);
+    ChallengeId__drop(challenge_id);
+  }
+
+  ItsukuSolver__drop(solver);
+}
+
+void test_pipeline_builds_next_challenge() {
+  const char *name = "Pipeline Builds the Next Challenge";
+  printf("  [Test] %s\n", name);
+
+  Config config = solver_test_config();
+  SearchOptions options = SearchOptions__default();
+  options.thread_count = 2;
+  ItsukuPipeline *pipeline = ItsukuPipeline__new(config, &options, 1);
+  ItsukuSolver *reference = ItsukuSolver__new(config, &options);
+  TEST_ASSERT(pipeline != NULL && reference != NULL, name);
+  if (!pipeline || !reference) {
+    ItsukuPipeline__drop(pipeline);
+    ItsukuSolver__drop(reference);
+    return;
+  }
+
+  ChallengeId *challenges[4];
+  uint8_t bytes[32];
+  for (int i = 0; i < 4; ++i) {
+    memset(bytes, 0x50 + i, sizeof(bytes));
+    challenges[i] = ChallengeId__new(bytes, sizeof(bytes));
+  }
+  // Challenge 3 is announced, but challenge 0 comes instead
+  const int order[] = {0, 1, 2, 0};
+  const int announced[] = {1, 2, 3, -1};
+
+  for (int i = 0; i < 4; ++i) {
+    ChallengeId *current = challenges[order[i]];
+    ChallengeId *next = announced[i] >= 0 ? challenges[announced[i]] : NULL;
+
+    SearchResult result = ItsukuPipeline__solve(pipeline, current, 8, next, 8);
+    TEST_ASSERT(result.status == SearchStatus__Found, name);
+    TEST_ASSERT(ItsukuSolver__is_prepared(pipeline->search_slot, current, 8),
+                name);
+
+    SearchResult expected = ItsukuSolver__solve(reference, current, 8);
+    if (result.proof && expected.proof) {
+      TEST_ASSERT(result.proof->nonce == expected.proof->nonce, name);
+      TEST_ASSERT(Proof__verify(result.proof) == VerificationError__Ok, name);
+    }
+    Proof__drop(result.proof);
+    Proof__drop(expected.proof);
+  }
+
+  // The announced challenge ends up prepared in the build slot
+  ItsukuPipeline__drop(pipeline);
+  pipeline = ItsukuPipeline__new(config, &options, 1);
+  SearchResult result =
+      ItsukuPipeline__solve(pipeline, challenges[0], 8, challenges[1], 10);
+  Proof__drop(result.proof);
+  ItsukuPipeline__wait_build(pipeline);
+  TEST_ASSERT(ItsukuSolver__is_prepared(pipeline->build_slot, challenges[1],
+                                        10),
+              name);
+
+  for (int i = 0; i < 4; ++i) {
+    ChallengeId__drop(challenges[i]);
+  }
+  ItsukuPipeline__drop(pipeline);
+  ItsukuSolver__drop(reference);
+}